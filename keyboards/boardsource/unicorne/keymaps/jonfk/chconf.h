@@ -0,0 +1,6 @@
+#pragma once
+
+/* Halt the core while the main loop sleeps between paced scans (ADAPTIVE_SCAN_ENABLE) */
+#define CORTEX_ENABLE_WFI_IDLE TRUE
+
+#include_next <chconf.h>
@@ -1,6 +1,9 @@
 
 #pragma once
 
+/* Per key, eager on press and deferred on release (EAGER_DEBOUNCE_ENABLE), see sim/bounce.c */
+#define DEBOUNCE 5
+
 #define TAPPING_TERM 200
 #define PERMISSIVE_HOLD
 
@@ -8,3 +11,14 @@
 
 #define ENCODERS_PAD_A { B12 }
 #define ENCODERS_PAD_B { B13 }
+
+/* All of unicorne_layers remappable (KEYMAP_STORE_ENABLE); they encode to about 370 bytes of the default 512 */
+#define KEYMAP_STORE_LAYERS 6
+
+/*
+ * The RP2040's emulated EEPROM, made explicit: 8 KB of flash, 4 KB usable.
+ * The user datablock (64 B tapping terms, 1600 B heatmap, 512 B keymap)
+ * follows the core's eeconfig; users/jonfk/config.h checks that it fits.
+ */
+#define WEAR_LEVELING_BACKING_SIZE 8192
+#define WEAR_LEVELING_LOGICAL_SIZE 4096
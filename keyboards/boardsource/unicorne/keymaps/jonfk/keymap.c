@@ -1,44 +1,13 @@
 #include QMK_KEYBOARD_H
+#include "jonfk.h"
+#include "combos.h"
 
-enum unicorne_layers {_DVORAK, _QWERTY, _SYM, _NUM, _ADJUST, _NAV};
-
-enum unicorne_keycodes { QWERTY = SAFE_RANGE,  DVORAK, MT_TILD, MT_DQUO, MA_WI_COPY, MA_WI_CUT, MA_WI_PSTE };
+enum unicorne_layers {_SYM = USER_SAFE_LAYER, _NUM, _ADJUST, _NAV};
 
 #define SYM MO(_SYM)
 #define NUM MO(_NUM)
 #define NAV MO(_NAV)
 
-
-// Dvorak: Left-hand bottom row mods
-#define BR_SCLN LGUI_T(KC_SCLN)
-#define BR_Q LALT_T(KC_Q)
-#define BR_J LSFT_T(KC_J)
-#define BR_K LCTL_T(KC_K)
-
-// Dvorak: Right-hand bottom row mods
-#define BR_M RCTL_T(KC_M)
-#define BR_W RSFT_T(KC_W)
-#define BR_V LALT_T(KC_V)
-#define BR_Z RGUI_T(KC_Z)
-
-/*
-Note that custom keycodes are used because of Mod Tap caveats not working with keycodes past a certain level.
-    See: https://docs.qmk.fm/mod_tap#caveats
-*/
-// LOWER: Left-hand bottom row mods
-// MT_TILD defined as custom keycode Unsupported because not basic keycode
-// See https://precondition.github.io/home-row-mods#using-non-basic-keycodes-in-mod-taps
-#define BR_TILD LGUI_T(MT_TILD)
-//#define BR_ASTR LALT_T(KC_KP_ASTERISK) // Defined on base layer, pass through
-#define BR_DQUO LSFT_T(MT_DQUO)
-#define BR_QUOT LCTL_T(KC_QUOT)
-
-// LOWER: Right-hand bottom row mods
-// First finger not necessary, pass through
-#define BR_LBRC RSFT_T(KC_LBRC)
-#define BR_RBRC RALT_T(KC_RBRC)
-// last finger not necessary, pass through
-
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 	[_DVORAK] = LAYOUT_split_3x6_3(
   //,-----------------------------------------------------.                    ,-----------------------------------------------------.
@@ -117,85 +86,18 @@ layer_state_t layer_state_set_user(layer_state_t state) {
     return update_tri_layer_state(state, _SYM, _NUM, _ADJUST);
 }
 
-bool process_record_user(uint16_t keycode, keyrecord_t *record) {
-    switch (keycode) {
-        // Workaround for caveats of Mod-Taps on non-basic keycodes
-        case BR_TILD:
-            if (record->event.pressed && record->tap.count > 0) {
-                // send keycode
-                // the 16 bit version of the `tap_code` function is used here
-                // because KC_TILD is a non-basic keycode.
-                tap_code16(KC_TILD);
-                // do not continue with default tap action
-                // if the MT was pressed or released, but not held
-                return false;
-            }
-            break;
-        case BR_DQUO:
-            if (record->event.pressed && record->tap.count > 0) {
-                // send keycode
-                // the 16 bit version of the `tap_code` function is used here
-                // because KC_TILD is a non-basic keycode.
-                tap_code16(KC_DQUO);
-                // do not continue with default tap action
-                // if the MT was pressed or released, but not held
-                return false;
-            }
-            break;
-        // Macros
-        case MA_WI_COPY:
-            if (record->event.pressed) {
-                SEND_STRING(SS_LCTL("c"));
-            }
-            break;
-        case MA_WI_CUT:
-            if (record->event.pressed) {
-                SEND_STRING(SS_LCTL("x"));
-            }
-            break;
-        case MA_WI_PSTE:
-            if (record->event.pressed) {
-                SEND_STRING(SS_LCTL("v"));
-            }
-            break;
-        // End Macros
-        case QWERTY:
-            if (record->event.pressed) {
-                set_single_persistent_default_layer(_QWERTY);
-            }
-            return false;
-            break;
-        case DVORAK:
-            if (record->event.pressed) {
-                set_single_persistent_default_layer(_DVORAK);
-            }
-            return false;
-            break;
+#ifdef LAYER_LIGHTS_ENABLE
+HSV layer_lights_color_keymap(uint8_t layer) {
+    switch (layer) {
+        case _SYM:
+            return (HSV){HSV_PURPLE};
+        case _NUM:
+            return (HSV){HSV_ORANGE};
+        case _NAV:
+            return (HSV){HSV_CYAN};
+        case _ADJUST:
+            return (HSV){HSV_RED};
     }
-    return true;
-}
-
-const uint16_t PROGMEM combo_jk[] = {KC_J, KC_K, COMBO_END};
-const uint16_t PROGMEM caps_combo[] = {BR_J, BR_W, COMBO_END};
-
-enum combo_events {
-  ESC_COMBO,
-  CAPS_COMBO,
-  // Other combos...
-  COMBO_LENGTH
-};
-
-combo_t key_combos[] = {
-    [ESC_COMBO] = COMBO(combo_jk, KC_ESC),
-    [CAPS_COMBO] = COMBO_ACTION(caps_combo),
-};
-
-void process_combo_event(uint16_t combo_index, bool pressed) {
-  switch(combo_index) {
-    case CAPS_COMBO:
-      if (pressed) {
-        caps_word_on();  // Activate Caps Word!
-      }
-      break;
-  }
+    return (HSV){0, 0, 0};
 }
+#endif
@@ -1,3 +1,11 @@
 COMBO_ENABLE = yes
+EAGER_DEBOUNCE_ENABLE = yes
 CAPS_WORD_ENABLE = yes
+SPLIT_SYNC_ENABLE = yes
+LAYER_LIGHTS_ENABLE = yes
 POINTING_DEVICE_ENABLE = no
+HEATMAP_ENABLE = yes
+HID_COMMAND_ENABLE = yes
+KEYMAP_STORE_ENABLE = yes
+TEXT_EXPANSION_ENABLE = yes
+ADAPTIVE_SCAN_ENABLE = yes
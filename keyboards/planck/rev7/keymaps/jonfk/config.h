@@ -42,5 +42,19 @@
 */
 // #define MIDI_ADVANCED
 
+/* Per key, eager on press and deferred on release (EAGER_DEBOUNCE_ENABLE), see sim/bounce.c */
+#define DEBOUNCE 5
+
 #define TAPPING_TERM 200
 #define PERMISSIVE_HOLD
+
+/* All of planck_layers remappable (KEYMAP_STORE_ENABLE); they encode to about 620 bytes */
+#define KEYMAP_STORE_DATA_SIZE 768
+
+/*
+ * Emulated EEPROM in the last 8 KB of flash, 4 KB of it usable. The user
+ * datablock (64 B tapping terms, 1600 B heatmap, 768 B keymap) follows the
+ * core's eeconfig; users/jonfk/config.h checks that it fits.
+ */
+#define WEAR_LEVELING_BACKING_SIZE 8192
+#define WEAR_LEVELING_LOGICAL_SIZE 4096
@@ -15,10 +15,13 @@
  */
 
 #include QMK_KEYBOARD_H
+#include "jonfk.h"
+#include "keymap_steno.h"
+#include "combos.h"
 
-enum planck_layers {_DVORAK, _QWERTY, _COLEMAK, _LOWER, _RAISE, _PLOVER, _ADJUST, _NAV};
+enum planck_layers {_COLEMAK = USER_SAFE_LAYER, _LOWER, _RAISE, _PLOVER, _ADJUST, _NAV};
 
-enum planck_keycodes { QWERTY = SAFE_RANGE, COLEMAK, DVORAK, PLOVER, BACKLIT, EXT_PLV, MT_TILD, MT_DQUO, MA_WI_COPY, MA_WI_CUT, MA_WI_PSTE };
+enum planck_keycodes { COLEMAK = USER_SAFE_RANGE, PLOVER, BACKLIT, EXT_PLV };
 
 // Dvorak: Left-hand home row mods
 #define HR_A LGUI_T(KC_A)
@@ -32,18 +35,6 @@ enum planck_keycodes { QWERTY = SAFE_RANGE, COLEMAK, DVORAK, PLOVER, BACKLIT, EX
 #define HR_N LALT_T(KC_N)
 #define HR_S RGUI_T(KC_S)
 
-// Dvorak: Left-hand home row mods
-#define BR_SCLN LGUI_T(KC_SCLN)
-#define BR_Q LALT_T(KC_Q)
-#define BR_J LSFT_T(KC_J)
-#define BR_K LCTL_T(KC_K)
-
-// Dvorak: Right-hand bottom row mods
-#define BR_M RCTL_T(KC_M)
-#define BR_W RSFT_T(KC_W)
-#define BR_V LALT_T(KC_V)
-#define BR_Z RGUI_T(KC_Z)
-
 /*
 Note that KP keys are used because of Mod Tap caveats not working with keycodes past a certain level.
     See: https://docs.qmk.fm/mod_tap#caveats
@@ -60,20 +51,6 @@ Note that KP keys are used because of Mod Tap caveats not working with keycodes
 #define HR_RCBR LALT_T(KC_RCBR)
 #define HR_BSLS RGUI_T(KC_BSLS)
 
-// LOWER: Left-hand bottom row mods
-// MT_TILD defined as custom keycode Unsupported because not basic keycode
-// See https://precondition.github.io/home-row-mods#using-non-basic-keycodes-in-mod-taps
-#define BR_TILD LGUI_T(MT_TILD)
-//#define BR_ASTR LALT_T(KC_KP_ASTERISK) // Defined on base layer, pass through
-#define BR_DQUO LSFT_T(MT_DQUO)
-#define BR_QUOT LCTL_T(KC_QUOT)
-
-// LOWER: Right-hand bottom row mods
-// First finger not necessary, pass through
-#define BR_LBRC RSFT_T(KC_LBRC)
-#define BR_RBRC RALT_T(KC_RBRC)
-// last finger not necessary, pass through
-
 #define LOWER MO(_LOWER)
 #define RAISE MO(_RAISE)
 #define NAV MO(_NAV)
@@ -202,7 +179,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 //|-----------------------------------------------------------------------------------------------------------------------.
 ),
 
-/* Plover layer (http://opensteno.org)
+/* Plover layer (http://opensteno.org), sent as GeminiPR over the virtual serial port
  * ,-----------------------------------------------------------------------------------.
  * |   #  |   #  |   #  |   #  |   #  |   #  |   #  |   #  |   #  |   #  |   #  |   #  |
  * |------+------+------+------+------+------+------+------+------+------+------+------|
@@ -214,10 +191,10 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  * `-----------------------------------------------------------------------------------'
  */
 [_PLOVER] = LAYOUT_planck_grid(
-    KC_1,    KC_1,    KC_1,    KC_1,    KC_1,    KC_1,    KC_1,    KC_1,    KC_1,    KC_1,    KC_1,    KC_1   ,
-    XXXXXXX, KC_Q,    KC_W,    KC_E,    KC_R,    KC_T,    KC_Y,    KC_U,    KC_I,    KC_O,    KC_P,    KC_LBRC,
-    XXXXXXX, KC_A,    KC_S,    KC_D,    KC_F,    KC_G,    KC_H,    KC_J,    KC_K,    KC_L,    KC_SCLN, KC_QUOT,
-    EXT_PLV, XXXXXXX, XXXXXXX, KC_C,    KC_V,    XXXXXXX, XXXXXXX, KC_N,    KC_M,    XXXXXXX, XXXXXXX, XXXXXXX
+    STN_N1,  STN_N2,  STN_N3,  STN_N4,  STN_N5,  STN_N6,  STN_N7,  STN_N8,  STN_N9,  STN_NA,  STN_NB,  STN_NC ,
+    XXXXXXX, STN_S1,  STN_TL,  STN_PL,  STN_HL,  STN_ST1, STN_ST3, STN_FR,  STN_PR,  STN_LR,  STN_TR,  STN_DR,
+    XXXXXXX, STN_S2,  STN_KL,  STN_WL,  STN_RL,  STN_ST2, STN_ST4, STN_RR,  STN_BR,  STN_GR,  STN_SR,  STN_ZR,
+    EXT_PLV, XXXXXXX, XXXXXXX, STN_A,   STN_O,   XXXXXXX, XXXXXXX, STN_E,   STN_U,   XXXXXXX, XXXXXXX, XXXXXXX
 ),
 
 /* Adjust (Lower + Raise)
@@ -227,7 +204,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  * |------+------+------+------+------+------+------+------+------+------+------+------|
  * |      |      |MUSmod|Aud on|Audoff|AGnorm|AGswap|Qwerty|Colemk|Dvorak|Plover|      |
  * |------+------+------+------+------+------+------+------+------+------+------+------|
- * |      |Voice-|Voice+|Mus on|Musoff|MIDIon|MIDIof|      |      |      |      |      |
+ * |      |Voice-|Voice+|Mus on|Musoff|MIDIon|MIDIof|NoteTg|      |      |      |      |
  * |------+------+------+------+------+------+------+------+------+------+------+------|
  * |      |      |      |      |      |             |      |      |      |      |      |
  * `-----------------------------------------------------------------------------------'
@@ -235,7 +212,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 [_ADJUST] = LAYOUT_planck_grid(
     _______, QK_BOOT, DB_TOGG, RGB_TOG, RGB_MOD, RGB_HUI, RGB_HUD, RGB_SAI, RGB_SAD, RGB_VAI, RGB_VAD, KC_DEL ,
     _______, EE_CLR,  MU_NEXT, AU_ON,   AU_OFF,  AG_NORM, AG_SWAP, QWERTY,  COLEMAK, DVORAK,  PLOVER,  _______,
-    _______, AU_PREV, AU_NEXT, MU_ON,   MU_OFF,  MI_ON,   MI_OFF,  _______, _______, _______, _______, _______,
+    _______, AU_PREV, AU_NEXT, MU_ON,   MU_OFF,  MI_ON,   MI_OFF,  NOTE_TG, _______, _______, _______, _______,
     _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______
 )
 
@@ -251,64 +228,11 @@ layer_state_t layer_state_set_user(layer_state_t state) {
     return update_tri_layer_state(state, _LOWER, _RAISE, _ADJUST);
 }
 
-bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+bool process_record_keymap(uint16_t keycode, keyrecord_t *record) {
     switch (keycode) {
-        // Workaround for caveats of Mod-Taps on non-basic keycodes
-        case BR_TILD:
-            if (record->event.pressed && record->tap.count > 0) {
-                // send keycode
-                // the 16 bit version of the `tap_code` function is used here
-                // because KC_TILD is a non-basic keycode.
-                tap_code16(KC_TILD);
-                // do not continue with default tap action
-                // if the MT was pressed or released, but not held
-                return false;
-            }
-            break;
-        case BR_DQUO:
-            if (record->event.pressed && record->tap.count > 0) {
-                // send keycode
-                // the 16 bit version of the `tap_code` function is used here
-                // because KC_TILD is a non-basic keycode.
-                tap_code16(KC_DQUO);
-                // do not continue with default tap action
-                // if the MT was pressed or released, but not held
-                return false;
-            }
-            break;
-        // Macros
-        case MA_WI_COPY:
-            if (record->event.pressed) {
-                SEND_STRING(SS_LCTL("c"));
-            }
-            break;
-        case MA_WI_CUT:
-            if (record->event.pressed) {
-                SEND_STRING(SS_LCTL("x"));
-            }
-            break;
-        case MA_WI_PSTE:
-            if (record->event.pressed) {
-                SEND_STRING(SS_LCTL("v"));
-            }
-            break;
-        // End Macros
-        case QWERTY:
-            if (record->event.pressed) {
-                print("mode just switched to qwerty and this is a huge string\n");
-                set_single_persistent_default_layer(_QWERTY);
-            }
-            return false;
-            break;
         case COLEMAK:
             if (record->event.pressed) {
-                set_single_persistent_default_layer(_COLEMAK);
-            }
-            return false;
-            break;
-        case DVORAK:
-            if (record->event.pressed) {
-                set_single_persistent_default_layer(_DVORAK);
+                settings_set_default_layer(_COLEMAK);
             }
             return false;
             break;
@@ -330,12 +254,6 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 layer_off(_LOWER);
                 layer_off(_ADJUST);
                 layer_on(_PLOVER);
-                if (!eeconfig_is_enabled()) {
-                    eeconfig_init();
-                }
-                keymap_config.raw  = eeconfig_read_keymap();
-                keymap_config.nkro = 1;
-                eeconfig_update_keymap(keymap_config.raw);
             }
             return false;
             break;
@@ -352,55 +270,6 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
     return true;
 }
 
-/* clang-format off */
-float melody[8][2][2] = {
-    {{440.0f, 8}, {440.0f, 24}}, 
-    {{440.0f, 8}, {440.0f, 24}}, 
-    {{440.0f, 8}, {440.0f, 24}}, 
-    {{440.0f, 8}, {440.0f, 24}}, 
-    {{440.0f, 8}, {440.0f, 24}}, 
-    {{440.0f, 8}, {440.0f, 24}}, 
-    {{440.0f, 8}, {440.0f, 24}}, 
-    {{440.0f, 8}, {440.0f, 24}},
-};
-/* clang-format on */
-
-#define JUST_MINOR_THIRD 1.2
-#define JUST_MAJOR_THIRD 1.25
-#define JUST_PERFECT_FOURTH 1.33333333
-#define JUST_TRITONE 1.42222222
-#define JUST_PERFECT_FIFTH 1.33333333
-
-#define ET12_MINOR_SECOND 1.059463
-#define ET12_MAJOR_SECOND 1.122462
-#define ET12_MINOR_THIRD 1.189207
-#define ET12_MAJOR_THIRD 1.259921
-#define ET12_PERFECT_FOURTH 1.33484
-#define ET12_TRITONE 1.414214
-#define ET12_PERFECT_FIFTH 1.498307	
-
-deferred_token tokens[8];
-
-uint32_t reset_note(uint32_t trigger_time, void *note) {
-    *(float*)note = 440.0f;
-    return 0;
-}
-
-// bool encoder_update_user(uint8_t index, bool clockwise) {
-//     cancel_deferred_exec(tokens[index]);
-//     if (clockwise) {
-//         melody[index][1][0] = melody[index][1][0] * ET12_MINOR_SECOND;
-//         melody[index][0][0] = melody[index][1][0] / ET12_PERFECT_FIFTH;
-//         audio_play_melody(&melody[index], 2, false);
-//     } else {
-//         melody[index][1][0] = melody[index][1][0] / ET12_MINOR_SECOND;
-//         melody[index][0][0] = melody[index][1][0] * ET12_TRITONE;
-//         audio_play_melody(&melody[index], 2, false);
-//     }
-//     tokens[index] = defer_exec(1000, reset_note, &melody[index][1][0]);
-//     return false;
-// }
-
 bool dip_switch_update_user(uint8_t index, bool active) {
     switch (index) {
         case 0: {
@@ -431,39 +300,15 @@ bool dip_switch_update_user(uint8_t index, bool active) {
     return true;
 }
 
-const uint16_t PROGMEM combo_jk[] = {KC_J, KC_K, COMBO_END};
-const uint16_t PROGMEM caps_combo[] = {BR_J, BR_W, COMBO_END};
-
-enum combo_events {
-  ESC_COMBO,
-  CAPS_COMBO,
-  // Other combos...
-  COMBO_LENGTH
-};
-combo_t key_combos[] = {
-    [ESC_COMBO] = COMBO(combo_jk, KC_ESC),
-    [CAPS_COMBO] = COMBO_ACTION(caps_combo),
-};
-
-void process_combo_event(uint16_t combo_index, bool pressed) {
-  switch(combo_index) {
-    case CAPS_COMBO:
-      if (pressed) {
-        caps_word_on();  // Activate Caps Word!
-      }
-      break;
-  }
-}
-
 #if defined(ENCODER_MAP_ENABLE)
 const uint16_t PROGMEM encoder_map[][NUM_ENCODERS][NUM_DIRECTIONS] = {
-    [_DVORAK] = { ENCODER_CCW_CW(KC_MS_WH_UP, KC_MS_WH_DOWN) },
-    [_QWERTY] = { ENCODER_CCW_CW(KC_MS_WH_UP, KC_MS_WH_DOWN) },
-    [_COLEMAK] = { ENCODER_CCW_CW(KC_MS_WH_UP, KC_MS_WH_DOWN) },
-    [_NAV] = { ENCODER_CCW_CW(KC_MS_WH_UP, KC_MS_WH_DOWN) },
-    [_LOWER] = { ENCODER_CCW_CW(KC_MS_WH_UP, KC_MS_WH_DOWN) },
-    [_PLOVER] = { ENCODER_CCW_CW(KC_MS_WH_UP, KC_MS_WH_DOWN) },
-    [_ADJUST] = { ENCODER_CCW_CW(KC_MS_WH_UP, KC_MS_WH_DOWN) },
+    [_DVORAK] = { ENCODER_CCW_CW(SCRL_UP, SCRL_DN) },
+    [_QWERTY] = { ENCODER_CCW_CW(SCRL_UP, SCRL_DN) },
+    [_COLEMAK] = { ENCODER_CCW_CW(SCRL_UP, SCRL_DN) },
+    [_NAV] = { ENCODER_CCW_CW(SCRL_UP, SCRL_DN) },
+    [_LOWER] = { ENCODER_CCW_CW(SCRL_UP, SCRL_DN) },
+    [_PLOVER] = { ENCODER_CCW_CW(SCRL_UP, SCRL_DN) },
+    [_ADJUST] = { ENCODER_CCW_CW(NOTE_DN, NOTE_UP) },
     [_RAISE] = { ENCODER_CCW_CW(KC_VOLD, KC_VOLU) },
 };
 #endif
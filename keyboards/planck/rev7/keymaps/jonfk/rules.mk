@@ -1,7 +1,19 @@
-DEFERRED_EXEC_ENABLE = yes
 AUDIO_ENABLE = yes
+WAVETABLE_AUDIO_ENABLE = yes
 COMBO_ENABLE = yes
+EAGER_DEBOUNCE_ENABLE = yes
 CAPS_WORD_ENABLE = yes
 ENCODER_ENABLE = yes
 ENCODER_MAP_ENABLE = yes
+ENCODER_SCROLL_ENABLE = yes
+ENCODER_NOTES_ENABLE = yes
 CONSOLE_ENABLE = no
+STENO_ENABLE = yes
+STENO_PROTOCOL = geminipr
+LATENCY_TRACE_ENABLE = yes
+HEATMAP_ENABLE = yes
+HID_COMMAND_ENABLE = yes
+KEYMAP_STORE_ENABLE = yes
+TEXT_EXPANSION_ENABLE = yes
+EEPROM_DRIVER = wear_leveling
+WEAR_LEVELING_DRIVER = embedded_flash
@@ -0,0 +1,263 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The Planck's DAC sample generator, users/jonfk/wavetable.c, on the host.
+ *
+ * Times dac_value_generate() with every number of tones from silence to a
+ * full chord, best of several rounds: the per-sample cost must not depend on how many are sounding.
+ * Checks that silence sits exactly at mid-scale, that no chord leaves the
+ * DAC range and that a tone comes out at its pitch. Then feeds the scan rate
+ * meter a silent stretch and a playing one at known scan rates and reads
+ * them back over the raw HID handler. Last, plays a tone and lets it end:
+ * the DAC timer must stop once a DMA buffer of silence has gone out, keep
+ * running through a melody's rest, and start again for the next tone.
+ *
+ *     sim/build/sim_audio [-n samples]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <hal.h>
+
+#include QMK_KEYBOARD_H
+#include "wavetable.h"
+#include "audio_dac.h"
+#include "raw_hid.h"
+
+#define VOICES AUDIO_MAX_SIMULTANEOUS_TONES
+#define DAC_MID (AUDIO_DAC_SAMPLE_MAX / 2)
+#define ROUNDS 5
+
+static const float chord[] = {440.0f, 554.37f, 659.26f, 880.0f, 1108.73f, 1318.51f, 1760.0f, 2217.46f};
+
+static uint8_t  tones;
+static bool     melody;
+static uint32_t now;
+static uint32_t timer_starts;
+static uint8_t  reply[RAW_EPSIZE];
+
+static volatile uint32_t sink; // keeps the timed samples from being optimised away
+
+_Static_assert(VOICES <= sizeof(chord) / sizeof(chord[0]), "not enough chord notes for every voice");
+
+/* Core stubs */
+
+uint32_t timer_read32(void) {
+    return now;
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return now - last;
+}
+
+uint8_t audio_get_number_of_active_tones(void) {
+    return tones;
+}
+
+float audio_get_processed_frequency(uint8_t tone_index) {
+    return chord[tone_index];
+}
+
+bool audio_is_playing_melody(void) {
+    return melody;
+}
+
+GPTDriver GPTD6;
+
+void audio_driver_start(void) {
+    GPTD6.state = GPT_CONTINUOUS;
+    timer_starts++;
+}
+
+void gptStopTimer(GPTDriver *gptp) {
+    gptp->state = GPT_READY;
+}
+
+void raw_hid_send(uint8_t *data, uint8_t length) {
+    memcpy(reply, data, length);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void play(uint8_t n) {
+    tones = n;
+    wavetable_task();
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* Housekeeping passes at a fixed number of scans per millisecond */
+static void scan(uint32_t ms, uint32_t scans_per_ms) {
+    for (uint32_t t = 0; t < ms; t++, now++) {
+        for (uint32_t i = 0; i < scans_per_ms; i++) {
+            wavetable_task();
+        }
+    }
+}
+
+static bool dac_running(void) {
+    return GPTD6.state == GPT_CONTINUOUS;
+}
+
+/* The DAC interrupt, one sample per timer tick while the timer runs, then a housekeeping pass */
+static void run_dac(uint32_t samples) {
+    for (uint32_t i = 0; i < samples && dac_running(); i++) {
+        sink += dac_value_generate();
+    }
+    wavetable_task();
+}
+
+/* Samples of silence after a tone ends until the timer stops, or 0 if it never does */
+static uint32_t samples_to_stop(void) {
+    play(1);
+    run_dac(AUDIO_DAC_BUFFER_SIZE);
+    play(0);
+    for (uint32_t n = 0; n <= 4 * AUDIO_DAC_BUFFER_SIZE; n += AUDIO_DAC_BUFFER_SIZE / 8) {
+        if (!dac_running()) {
+            return n;
+        }
+        run_dac(AUDIO_DAC_BUFFER_SIZE / 8);
+    }
+    return 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n samples]\n", argv0);
+    fprintf(stderr, "  -n samples  samples timed per tone count and round (default %u)\n", 4 * AUDIO_DAC_SAMPLE_RATE);
+}
+
+int main(int argc, char **argv) {
+    uint32_t samples = 4 * AUDIO_DAC_SAMPLE_RATE;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            samples = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (samples < AUDIO_DAC_SAMPLE_RATE) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    bool   ok = true;
+    double cost[VOICES + 1];
+
+    printf("generator     %u voices, %u Hz, %u-bit DAC\n", VOICES, AUDIO_DAC_SAMPLE_RATE, 32 - __builtin_clz(AUDIO_DAC_SAMPLE_MAX));
+    // Best of several rounds, taken in turn, so a busy host does not land on one tone count.
+    for (uint8_t round = 0; round < ROUNDS; round++) {
+        for (uint8_t n = 0; n <= VOICES; n++) {
+            play(n);
+            uint64_t start = now_ns();
+            for (uint32_t i = 0; i < samples; i++) {
+                sink += dac_value_generate();
+            }
+            double ns = (double)(now_ns() - start) / samples;
+            cost[n]   = round ? MIN(cost[n], ns) : ns;
+        }
+    }
+    for (uint8_t n = 0; n <= VOICES; n++) {
+        play(n);
+        uint16_t lo = UINT16_MAX, hi = 0;
+        uint32_t rising = 0;
+        uint16_t prev   = DAC_MID;
+        for (uint32_t i = 0; i < AUDIO_DAC_SAMPLE_RATE; i++) {
+            uint16_t v = dac_value_generate();
+            lo         = MIN(lo, v);
+            hi         = MAX(hi, v);
+            // Upward crossings of mid-scale over a second give the pitch of a lone tone.
+            rising += prev < DAC_MID && v >= DAC_MID;
+            prev = v;
+        }
+
+        printf("%u tones       %.1f ns/sample, output %u..%u", n, cost[n], lo, hi);
+        if (n == 0 && (lo != DAC_MID || hi != DAC_MID)) {
+            printf("  NOT SILENT");
+            ok = false;
+        }
+        if (hi > AUDIO_DAC_SAMPLE_MAX) {
+            printf("  CLIPPED");
+            ok = false;
+        }
+        if (n == 1) {
+            printf(", %u Hz", rising);
+            if (abs((int)rising - (int)lrintf(chord[0])) > 1) {
+                printf("  OFF PITCH");
+                ok = false;
+            }
+        }
+        printf("\n");
+    }
+    double lo = cost[0], hi = cost[0];
+    for (uint8_t n = 1; n <= VOICES; n++) {
+        lo = MIN(lo, cost[n]);
+        hi = MAX(hi, cost[n]);
+    }
+    printf("cost spread   %.0f%% between the cheapest and dearest tone count\n", 100.0 * (hi - lo) / lo);
+
+    // The meter: silent at 10 scans/ms, then a chord that slows scanning to 9 scans/ms.
+    uint8_t clear[RAW_EPSIZE] = {WAVETABLE_HID_ID, WAVETABLE_HID_CLEAR};
+    wavetable_raw_hid_receive(clear, sizeof(clear));
+    play(0);
+    scan(3 * WAVETABLE_RATE_WINDOW_MS + 1, 10);
+    play(VOICES);
+    scan(3 * WAVETABLE_RATE_WINDOW_MS + 1, 9);
+    uint8_t request[RAW_EPSIZE] = {WAVETABLE_HID_ID, WAVETABLE_HID_INFO};
+    wavetable_raw_hid_receive(request, sizeof(request));
+
+    uint32_t silent = get_u32(&reply[8]), playing = get_u32(&reply[18]);
+    printf("scan rate     silent %u/s over %u windows, playing %u/s over %u windows\n", silent, reply[16] | reply[17] << 8, playing, reply[26] | reply[27] << 8);
+    if (silent != 10000 || playing != 9000) {
+        printf("scan rate     expected 10000/s silent and 9000/s playing\n");
+        ok = false;
+    }
+
+    // The stop path: the timer was started by the first tone above.
+    uint32_t stop_after = samples_to_stop();
+    melody              = true;
+    play(1);
+    run_dac(AUDIO_DAC_BUFFER_SIZE);
+    play(0);
+    run_dac(4 * AUDIO_DAC_BUFFER_SIZE);
+    bool kept_for_rest = dac_running();
+    melody             = false;
+    run_dac(4 * AUDIO_DAC_BUFFER_SIZE);
+    uint32_t starts = timer_starts;
+    play(1);
+    bool restarted = dac_running() && timer_starts == starts + 1;
+    play(0);
+    run_dac(4 * AUDIO_DAC_BUFFER_SIZE);
+
+    printf("dac timer     stopped %u samples after the last tone, %s through a melody's rest, %s for the next tone\n", stop_after, kept_for_rest ? "kept" : "STOPPED", restarted ? "restarted" : "NOT RESTARTED");
+    if (stop_after == 0 || stop_after > 2 * AUDIO_DAC_BUFFER_SIZE || !kept_for_rest || !restarted || dac_running()) {
+        ok = false;
+    }
+    printf("result        %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
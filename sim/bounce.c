@@ -0,0 +1,377 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Debounce algorithms against synthetic switch bounce.
+ *
+ * Typing is made up as keystrokes on random keys of the board's matrix, a
+ * few overlapping at a time. Each contact bounces for up to -b ms when it
+ * closes and again when it opens, toggling every 0.1 to 0.8 ms, and a
+ * share of the keystrokes (-c percent) also chatter open for 0.2 to 2 ms
+ * while held. The matrix is scanned every -p microseconds and each scan
+ * goes through every algorithm at once:
+ *
+ *   sym_defer_g     the core's default: the whole matrix waits for DEBOUNCE ms of quiet
+ *   sym_defer_pk    each key waits for DEBOUNCE ms of quiet
+ *   sym_eager_pk    each key changes at once, then ignores it for DEBOUNCE ms
+ *   eager_defer_pk  users/jonfk/eager_debounce.c: press at once, release after DEBOUNCE ms open
+ *
+ * The core's three are models of its debounce/ algorithms. Press latency is
+ * from the first contact to the debounced press, release latency from the
+ * first opening to the debounced release. A keystroke is chattered if it
+ * comes out as more than one press or releases while still held, and
+ * missed if it never comes out. The run fails unless eager_defer_pk is
+ * clean.
+ *
+ *     sim/build/sim_bounce_planck [-n keystrokes] [-b bounce_ms] [-c chatter_percent] [-p scan_us] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include QMK_KEYBOARD_H
+#include "debounce.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#define KEYS (MATRIX_ROWS * MATRIX_COLS)
+#define NONE UINT32_MAX
+
+typedef struct {
+    uint8_t  key;
+    uint32_t press_us;   // first contact
+    uint32_t release_us; // first opening
+    uint32_t next;       // next keystroke on the same key, or NONE
+} keystroke_t;
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t  key;
+    bool     closed;
+} edge_t;
+
+typedef bool (*debounce_fn_t)(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+
+typedef struct {
+    const char   *name;
+    debounce_fn_t debounce;
+    matrix_row_t  cooked[MATRIX_ROWS];
+    uint32_t      current[KEYS]; // latest keystroke started on each key
+    uint8_t      *presses;
+    bool         *early_release;
+    bool         *released;
+    uint64_t      press_total_us, release_total_us;
+    uint32_t      press_max_us, release_max_us;
+    uint32_t      releases;
+} algorithm_t;
+
+static uint32_t now_us;
+static uint32_t rng = 1;
+
+uint16_t timer_read(void) {
+    return (uint16_t)(now_us / 1000);
+}
+
+static uint32_t random_u32(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint32_t random_between(uint32_t lo, uint32_t hi) {
+    return lo + random_u32() % (hi - lo + 1);
+}
+
+/* Models of the core's algorithms, on the same millisecond timer */
+
+static bool sym_defer_g(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    static bool     counting;
+    static uint16_t start;
+    if (changed) {
+        counting = true;
+        start    = timer_read();
+    }
+    if (counting && TIMER_DIFF_16(timer_read(), start) >= DEBOUNCE) {
+        counting = false;
+        if (memcmp(cooked, raw, num_rows * sizeof(matrix_row_t)) != 0) {
+            memcpy(cooked, raw, num_rows * sizeof(matrix_row_t));
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool sym_defer_pk(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    static matrix_row_t last_raw[MATRIX_ROWS];
+    static uint16_t     start[KEYS];
+    static bool         counting[KEYS];
+    bool                cooked_changed = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            matrix_row_t bit = (matrix_row_t)1 << col;
+            uint8_t      k   = row * MATRIX_COLS + col;
+            if ((raw[row] ^ last_raw[row]) & bit) {
+                counting[k] = true;
+                start[k]    = timer_read();
+            }
+            if (counting[k] && TIMER_DIFF_16(timer_read(), start[k]) >= DEBOUNCE) {
+                counting[k] = false;
+                if ((raw[row] ^ cooked[row]) & bit) {
+                    cooked[row] ^= bit;
+                    cooked_changed = true;
+                }
+            }
+        }
+        last_raw[row] = raw[row];
+    }
+    return cooked_changed;
+}
+
+static bool sym_eager_pk(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    static uint16_t start[KEYS];
+    static bool     locked[KEYS];
+    bool            cooked_changed = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            matrix_row_t bit = (matrix_row_t)1 << col;
+            uint8_t      k   = row * MATRIX_COLS + col;
+            if (locked[k] && TIMER_DIFF_16(timer_read(), start[k]) >= DEBOUNCE) {
+                locked[k] = false;
+            }
+            if (!locked[k] && ((raw[row] ^ cooked[row]) & bit)) {
+                cooked[row] ^= bit;
+                cooked_changed = true;
+                locked[k]      = true;
+                start[k]       = timer_read();
+            }
+        }
+    }
+    return cooked_changed;
+}
+
+static algorithm_t algorithms[] = {
+    {.name = "sym_defer_g", .debounce = sym_defer_g},
+    {.name = "sym_defer_pk", .debounce = sym_defer_pk},
+    {.name = "sym_eager_pk", .debounce = sym_eager_pk},
+    {.name = "eager_defer_pk", .debounce = debounce},
+};
+
+#define ALGORITHMS (sizeof(algorithms) / sizeof(algorithms[0]))
+#define EAGER_DEFER (ALGORITHMS - 1)
+
+static keystroke_t *keystrokes;
+static edge_t      *edges;
+static uint32_t     edge_count;
+
+static void add_edge(uint32_t time_us, uint8_t key, bool closed) {
+    edges[edge_count++] = (edge_t){time_us, key, closed};
+}
+
+/* Toggles for up to bounce_us from start, ending on the level the contact settles at */
+static uint32_t add_bounce(uint32_t start, uint8_t key, bool settle, uint32_t bounce_us) {
+    uint32_t end   = start + random_between(0, bounce_us);
+    uint32_t t     = start;
+    bool     level = settle;
+    add_edge(t, key, level);
+    while (bounce_us && (t += random_between(100, 800)) < end) {
+        level = !level;
+        add_edge(t, key, level);
+    }
+    if (level != settle) {
+        add_edge(t, key, settle);
+    }
+    return t;
+}
+
+static int compare_edges(const void *a, const void *b) {
+    const edge_t *x = a, *y = b;
+    return x->time_us < y->time_us ? -1 : x->time_us > y->time_us;
+}
+
+static uint32_t make_typing(uint32_t count, uint32_t bounce_us, uint32_t chatter_percent) {
+    uint32_t free_at[KEYS] = {0};
+    uint32_t last[KEYS];
+    uint32_t t = 10000;
+    memset(last, 0xFF, sizeof(last));
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t key;
+        t += random_between(40000, 160000);
+        do {
+            key = random_u32() % KEYS;
+        } while (free_at[key] > t);
+
+        keystroke_t *k = &keystrokes[i];
+        k->key         = key;
+        k->press_us    = t;
+        k->next        = NONE;
+        if (last[key] != NONE) {
+            keystrokes[last[key]].next = i;
+        }
+        last[key] = i;
+
+        uint32_t settled = add_bounce(t, key, true, bounce_us);
+        k->release_us    = settled + random_between(40000, 200000);
+        if (random_u32() % 100 < chatter_percent) {
+            uint32_t open = random_between(settled + 1000, k->release_us - 3000);
+            add_edge(open, key, false);
+            add_edge(open + random_between(200, 2000), key, true);
+        }
+        free_at[key] = add_bounce(k->release_us, key, false, bounce_us) + 20000;
+    }
+    qsort(edges, edge_count, sizeof(edge_t), compare_edges);
+    return free_at[keystrokes[count - 1].key];
+}
+
+static void record(algorithm_t *a, const matrix_row_t before[]) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        matrix_row_t diff = before[row] ^ a->cooked[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (!(diff & (1 << col))) {
+                continue;
+            }
+            uint32_t i = a->current[row * MATRIX_COLS + col];
+            if (i == NONE) {
+                continue;
+            }
+            keystroke_t *k = &keystrokes[i];
+            if (a->cooked[row] & (1 << col)) {
+                if (a->presses[i]++ == 0) {
+                    uint32_t latency  = now_us - k->press_us;
+                    a->press_total_us += latency;
+                    a->press_max_us = MAX(a->press_max_us, latency);
+                }
+            } else if (now_us < k->release_us) {
+                a->early_release[i] = true;
+            } else if (!a->released[i]) {
+                uint32_t latency    = now_us - k->release_us;
+                a->released[i]      = true;
+                a->release_total_us += latency;
+                a->release_max_us = MAX(a->release_max_us, latency);
+                a->releases++;
+            }
+        }
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n keystrokes] [-b bounce_ms] [-c chatter_percent] [-p scan_us] [-s seed]\n", argv0);
+    fprintf(stderr, "  -n keystrokes       keystrokes typed (default 20000)\n");
+    fprintf(stderr, "  -b bounce_ms        longest bounce when a contact closes or opens (default 5)\n");
+    fprintf(stderr, "  -c chatter_percent  keystrokes that also chatter while held (default 2)\n");
+    fprintf(stderr, "  -p scan_us          matrix scan period (default 500)\n");
+    fprintf(stderr, "  -s seed             random seed (default 1)\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t count = 20000, bounce_ms = 5, chatter_percent = 2, scan_us = 500;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+            bounce_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-c") == 0) {
+            chatter_percent = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-p") == 0) {
+            scan_us = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            rng = (uint32_t)strtoul(argv[++i], NULL, 10) | 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (count == 0 || scan_us == 0 || chatter_percent > 100 || bounce_ms > 30) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    uint32_t max_edges = count * (2 * (bounce_ms * 1000 / 100 + 2) + 2);
+    keystrokes         = calloc(count, sizeof(keystroke_t));
+    edges              = calloc(max_edges, sizeof(edge_t));
+    for (uint32_t a = 0; a < ALGORITHMS; a++) {
+        algorithms[a].presses       = calloc(count, 1);
+        algorithms[a].early_release = calloc(count, sizeof(bool));
+        algorithms[a].released      = calloc(count, sizeof(bool));
+        memset(algorithms[a].current, 0xFF, sizeof(algorithms[a].current));
+    }
+    uint32_t end_us = make_typing(count, bounce_ms * 1000, chatter_percent);
+
+    matrix_row_t raw[MATRIX_ROWS] = {0}, last_raw[MATRIX_ROWS] = {0};
+    uint32_t     next_edge = 0, next_keystroke = 0;
+    debounce_init(MATRIX_ROWS);
+    for (now_us = 0; now_us <= end_us; now_us += scan_us) {
+        while (next_edge < edge_count && edges[next_edge].time_us <= now_us) {
+            const edge_t *e   = &edges[next_edge++];
+            matrix_row_t  bit = (matrix_row_t)1 << (e->key % MATRIX_COLS);
+            raw[e->key / MATRIX_COLS] = e->closed ? raw[e->key / MATRIX_COLS] | bit : raw[e->key / MATRIX_COLS] & ~bit;
+        }
+        while (next_keystroke < count && keystrokes[next_keystroke].press_us <= now_us) {
+            for (uint32_t a = 0; a < ALGORITHMS; a++) {
+                algorithms[a].current[keystrokes[next_keystroke].key] = next_keystroke;
+            }
+            next_keystroke++;
+        }
+        bool changed = memcmp(raw, last_raw, sizeof(raw)) != 0;
+        memcpy(last_raw, raw, sizeof(raw));
+
+        for (uint32_t a = 0; a < ALGORITHMS; a++) {
+            matrix_row_t before[MATRIX_ROWS];
+            memcpy(before, algorithms[a].cooked, sizeof(before));
+            if (algorithms[a].debounce(raw, algorithms[a].cooked, MATRIX_ROWS, changed)) {
+                record(&algorithms[a], before);
+            }
+        }
+    }
+
+    printf("board         %s, DEBOUNCE %u ms, scan every %u us\n", SIM_BOARD_NAME, DEBOUNCE, scan_us);
+    printf("typing        %u keystrokes, bounce up to %u ms, %u%% chatter while held\n", count, bounce_ms, chatter_percent);
+    printf("%-16s %21s %21s %10s %7s\n", "algorithm", "press ms mean/max", "release ms mean/max", "chattered", "missed");
+
+    int    best      = -1;
+    double best_mean = 0;
+    for (uint32_t a = 0; a < ALGORITHMS; a++) {
+        algorithm_t *al      = &algorithms[a];
+        uint32_t     chatter = 0, missed = 0, pressed = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            missed += al->presses[i] == 0;
+            pressed += al->presses[i] > 0;
+            chatter += al->presses[i] > 1 || al->early_release[i];
+        }
+        double press_mean   = pressed ? al->press_total_us / 1000.0 / pressed : 0;
+        double release_mean = al->releases ? al->release_total_us / 1000.0 / al->releases : 0;
+        printf("%-16s %10.2f / %-8.2f %10.2f / %-8.2f %9.2f%% %7u\n", al->name, press_mean, al->press_max_us / 1000.0, release_mean, al->release_max_us / 1000.0, 100.0 * chatter / count, missed);
+
+        bool clean = chatter == 0 && missed == 0;
+        if (clean && best != -2 && (best < 0 || press_mean < best_mean)) {
+            best      = a;
+            best_mean = press_mean;
+        }
+        if (a == EAGER_DEFER && !clean) {
+            best = -2;
+        }
+    }
+    if (best >= 0) {
+        printf("fastest clean %s\n", algorithms[best].name);
+    }
+    printf("result        %s\n", best == -2 ? "CHATTER" : "ok");
+    return best == -2 ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * users/jonfk/text_expansion.c on the host, against dictionaries of any size.
+ *
+ * Reads the triggers back out of the compiled trie, then types a stream of
+ * words through process_text_expansion(), each followed by a space: every
+ * other word a trigger, the others made-up words that are not. Reports the
+ * flash the dictionary takes and the cost of a key press and release with
+ * the housekeeping pass after it, best of several rounds, and checks that
+ * every trigger and nothing else was replaced by its text.
+ *
+ * The Makefile builds one per dictionary: sim_expand from expansions.txt and
+ * sim_expand_<n> from n synthetic expansions.
+ *
+ *     sim/build/sim_expand_2048 [-n words]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "jonfk.h"
+#include EXPANSIONS_DATA_H
+
+#define ROUNDS 5
+#define MAX_WORDS 4096
+#define TRIGGER_POS ((keypos_t){.row = 0, .col = 1})
+
+typedef struct {
+    char     trigger[EXPANSION_MAX_TRIGGER + 1];
+    uint16_t text;
+} expansion_t;
+
+static expansion_t expansions[EXPANSION_COUNT];
+static uint16_t    expansion_count;
+static uint64_t    backspaces, queued, passed;
+
+static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz;',./-";
+
+/* Core stubs */
+
+layer_state_t layer_state, default_layer_state;
+
+uint8_t get_mods(void) {
+    return 0;
+}
+
+uint8_t get_oneshot_mods(void) {
+    return 0;
+}
+
+uint8_t get_highest_layer(layer_state_t state) {
+    return state ? 31 - __builtin_clz(state) : 0;
+}
+
+uint16_t mod_tap_get_tap_keycode(uint16_t keycode) {
+    return QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+}
+
+bool macro_queue_tap16(uint16_t keycode) {
+    if (keycode == KC_BSPC) {
+        backspaces++;
+    } else {
+        queued++;
+    }
+    return true;
+}
+
+bool macro_queue_is_empty(void) {
+    return true;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static uint16_t trie_word(uint32_t offset) {
+    return expansion_trie[offset] | expansion_trie[offset + 1] << 8;
+}
+
+/* Every trigger below node, depth symbols in; the layout is in util/compile_expansions.py. */
+static void collect(uint16_t node, char *trigger, uint8_t depth) {
+    uint8_t  flags = expansion_trie[node];
+    uint32_t pos   = node + 1;
+    if (flags & 0x80) {
+        trigger[depth] = '\0';
+        strcpy(expansions[expansion_count].trigger, trigger);
+        expansions[expansion_count++].text = trie_word(pos);
+        pos += 2;
+    }
+    if (flags & 0x40) {
+        uint32_t bitmap = trie_word(pos) | (uint32_t)trie_word(pos + 2) << 16;
+        pos += 4;
+        for (uint8_t symbol = 0; symbol < 32; symbol++) {
+            if (bitmap & (1u << symbol)) {
+                trigger[depth] = alphabet[symbol];
+                collect(trie_word(pos), trigger, depth + 1);
+                pos += 2;
+            }
+        }
+    }
+}
+
+static uint16_t keycode_of(char c) {
+    const char *symbol = strchr(alphabet, c);
+    static const uint16_t punctuation[] = {KC_SCLN, KC_QUOT, KC_COMM, KC_DOT, KC_SLSH, KC_MINS};
+    return symbol - alphabet < 26 ? KC_A + (symbol - alphabet) : punctuation[symbol - alphabet - 26];
+}
+
+static void tap(uint16_t keycode) {
+    keyrecord_t record = {.event = {.key = TRIGGER_POS, .type = KEY_EVENT, .pressed = true}};
+    if (process_text_expansion(keycode, &record)) {
+        passed++;
+    }
+    record.event.pressed = false;
+    process_text_expansion(keycode, &record);
+    text_expansion_task();
+}
+
+static bool is_trigger(const char *word) {
+    for (uint16_t i = 0; i < expansion_count; i++) {
+        if (strcmp(expansions[i].trigger, word) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n words]\n", argv0);
+    fprintf(stderr, "  -n words  words typed per round, half of them triggers (default 20000)\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t words = 20000;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            words = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (words < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char trigger[EXPANSION_MAX_TRIGGER + 1];
+    collect(0, trigger, 0);
+
+    // The word list: triggers in turn, each followed by a made-up word that is not one.
+    static char list[MAX_WORDS][EXPANSION_MAX_TRIGGER + 2];
+    uint32_t    list_len = 0, hits = 0;
+    uint64_t    expected_backspaces = 0, expected_queued = 0;
+    srand(1);
+    while (list_len < MAX_WORDS && list_len < words) {
+        expansion_t *e = &expansions[(list_len / 2) % expansion_count];
+        if (list_len % 2 == 0) {
+            strcpy(list[list_len], e->trigger);
+        } else {
+            do {
+                uint8_t len = 2 + rand() % 5;
+                for (uint8_t i = 0; i < len; i++) {
+                    list[list_len][i] = 'a' + rand() % 26;
+                }
+                list[list_len][len] = '\0';
+            } while (is_trigger(list[list_len]));
+        }
+        list_len++;
+    }
+
+    uint64_t keys = 0;
+    double   best = 0;
+    for (uint8_t round = 0; round < ROUNDS; round++) {
+        backspaces = queued = passed = 0;
+        hits = keys = expected_backspaces = expected_queued = 0;
+        uint64_t start = now_ns();
+        for (uint32_t w = 0; w < words; w++) {
+            uint32_t    index = w % list_len;
+            const char *word  = list[index];
+            for (const char *c = word; *c; c++) {
+                tap(keycode_of(*c));
+            }
+            tap(KC_SPC);
+            keys += strlen(word) + 1;
+            if (index % 2 == 0) {
+                const expansion_t *e = &expansions[(index / 2) % expansion_count];
+                hits++;
+                expected_backspaces += strlen(e->trigger);
+                // The text, then the space that set it off
+                expected_queued += strlen((const char *)&expansion_text[e->text]) + 1;
+            }
+        }
+        double ns = (double)(now_ns() - start) / keys;
+        best      = round ? MIN(best, ns) : ns;
+    }
+
+    // Every key reaches the host but the spaces after triggers, which come out of the queue.
+    uint32_t expanded = keys - passed;
+    bool     ok       = expanded == hits && backspaces == expected_backspaces && queued == expected_queued;
+    printf("%5u expansions  trie %6zu B  text %6zu B  %5.1f B/expansion  %5.1f ns/key  %u of %u triggers expanded  %s\n", expansion_count, sizeof(expansion_trie), sizeof(expansion_text),
+           (double)(sizeof(expansion_trie) + sizeof(expansion_text)) / expansion_count, best, expanded, hits, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
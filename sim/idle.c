@@ -0,0 +1,308 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Both halves of the unicorne around users/jonfk/adaptive_scan.c, on a
+ * microsecond clock.
+ *
+ * Each half runs its main loop: a pass scans the half's matrix, the master's
+ * pass also reads the slave's last finished scan over the split transaction,
+ * then adaptive_scan_task runs and may sleep. Passes take -c us on the master
+ * and a third of that on the slave, give or take 25%. The slave's copy of
+ * adaptive_scan.c is a second build of it under other names. Keys are typed
+ * in bursts on random halves, with quiet stretches longer than
+ * ADAPTIVE_SCAN_IDLE_MS in between, so every burst starts with both loops
+ * paced. The first key of each burst must reach the master within
+ * ADAPTIVE_SCAN_PERIOD_US, or within what the loop takes without sleeping
+ * when its passes are too long for that, and the wait the master logs must never be
+ * shorter than the real one. Also reports each half's scan rate and the
+ * share of time it was awake, active and idle.
+ *
+ *     sim/build/sim_idle [-n bursts] [-c pass_us] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include QMK_KEYBOARD_H
+#include <ch.h>
+#include "adaptive_scan.h"
+#include "tlog.h"
+
+#define MASTER 0
+#define SLAVE 1
+#define MAX_BURSTS 400
+#define MAX_BURST_KEYS 20
+#define MAX_CHANGES (2 * MAX_BURSTS * MAX_BURST_KEYS)
+
+void     slave_adaptive_scan_task(void);
+uint16_t slave_adaptive_scan_rgb_flush_ms(void);
+
+typedef struct {
+    uint32_t time_us;
+    bool     first; // the key that ends a quiet stretch
+} change_t;
+
+typedef struct {
+    uint32_t pass_us;
+    uint32_t next_pass_us; // when the loop leaves its sleep
+    uint32_t activity_ms;  // last_matrix_activity_time()
+    change_t changes[MAX_CHANGES];
+    uint32_t change_count;
+    uint32_t scanned; // changes seen by this half's own scans
+    uint64_t busy_us[2], wall_us[2], passes[2]; // active, idle
+} half_t;
+
+static half_t   halves[2];
+static uint8_t  current;
+static uint32_t now_us;
+static uint32_t rng = 1;
+
+// The slave's scans as the master can read them: the last one finished by then.
+static struct {
+    uint32_t scanned, done_us;
+} published[2];
+static uint32_t master_read; // slave changes the master has seen
+
+static uint32_t logged_wait_us; // by the master's SCAN_WAKE in the current pass
+
+typedef struct {
+    uint32_t keys;  // bursts started on this half
+    uint32_t woken; // of which woke the master from idle
+    uint32_t max_us;
+    uint64_t total_us;
+} wait_stats_t;
+
+/* Core and kernel stubs, acting on the half that is running */
+
+systime_t chVTGetSystemTimeX(void) {
+    return now_us;
+}
+
+void chThdSleep(sysinterval_t interval) {
+    now_us += interval;
+    halves[current].next_pass_us = now_us;
+}
+
+uint32_t timer_read32(void) {
+    return now_us / 1000;
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return timer_read32() - last;
+}
+
+uint32_t last_matrix_activity_time(void) {
+    return halves[current].activity_ms;
+}
+
+void tlog_write(uint8_t token, const uint32_t *args, uint8_t count) {
+    if (current == MASTER && token == TLOG_SCAN_WAKE) {
+        logged_wait_us = args[1];
+    }
+}
+
+static uint32_t random_u32(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint32_t random_between(uint32_t lo, uint32_t hi) {
+    return lo + random_u32() % (hi - lo + 1);
+}
+
+static void add_change(uint8_t half, uint32_t time_us, bool first) {
+    half_t *h                     = &halves[half];
+    h->changes[h->change_count++] = (change_t){time_us, first};
+}
+
+/* Bursts of key presses and releases; returns when the last one ends. */
+static uint32_t make_bursts(uint32_t bursts) {
+    uint32_t t = 0;
+    for (uint32_t b = 0; b < bursts; b++) {
+        t += (ADAPTIVE_SCAN_IDLE_MS + random_between(500, 3000)) * 1000 + random_between(0, 999);
+        uint32_t keys = random_between(1, MAX_BURST_KEYS);
+        for (uint32_t k = 0; k < keys; k++) {
+            uint8_t  half = random_u32() & 1;
+            uint32_t hold = random_between(30, 150) * 1000;
+            add_change(half, t, k == 0);
+            add_change(half, t + hold, false);
+            t += hold + random_between(20, 200) * 1000;
+        }
+    }
+    // Releases can end up after the next press on the same half.
+    for (uint8_t half = MASTER; half <= SLAVE; half++) {
+        half_t *h = &halves[half];
+        for (uint32_t i = 1; i < h->change_count; i++) {
+            for (uint32_t j = i; j > 0 && h->changes[j - 1].time_us > h->changes[j].time_us; j--) {
+                change_t swap   = h->changes[j];
+                h->changes[j]   = h->changes[j - 1];
+                h->changes[j - 1] = swap;
+            }
+        }
+    }
+    return t;
+}
+
+/* Takes the changes up to time_us; sets *first_us if the first key of a burst is among them. */
+static bool take_changes(const half_t *h, uint32_t *seen, uint32_t time_us, uint32_t *first_us) {
+    bool changed = false;
+    while (*seen < h->change_count && h->changes[*seen].time_us <= time_us) {
+        if (h->changes[*seen].first) {
+            *first_us = h->changes[*seen].time_us;
+        }
+        (*seen)++;
+        changed = true;
+    }
+    return changed;
+}
+
+static void print_half(const char *name, const half_t *h) {
+    printf("%-13s", name);
+    for (uint8_t idle = 0; idle < 2; idle++) {
+        double seconds = h->wall_us[idle] / 1e6;
+        printf("  %s %6.0f scans/s, awake %3.0f%%", idle ? "idle" : "active", seconds > 0 ? h->passes[idle] / seconds : 0, h->wall_us[idle] ? 100.0 * h->busy_us[idle] / h->wall_us[idle] : 0);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t bursts = 100, pass_us = 150;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            bursts = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-c") == 0) {
+            pass_us = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            rng = (uint32_t)strtoul(argv[++i], NULL, 10) | 1;
+        } else {
+            fprintf(stderr, "usage: %s [-n bursts] [-c pass_us] [-s seed]\n", argv[0]);
+            fprintf(stderr, "  -n bursts   key bursts, each after a quiet stretch (default 100, at most %u)\n", MAX_BURSTS);
+            fprintf(stderr, "  -c pass_us  master pass, scan and split transaction (default 150)\n");
+            fprintf(stderr, "  -s seed     random seed\n");
+            return 2;
+        }
+    }
+    if (bursts == 0 || bursts > MAX_BURSTS || pass_us < 3) {
+        fprintf(stderr, "%s: need 1 to %u bursts and a pass of at least 3 us\n", argv[0], MAX_BURSTS);
+        return 2;
+    }
+
+    halves[MASTER].pass_us = pass_us;
+    halves[SLAVE].pass_us  = pass_us / 3;
+    uint32_t end_us        = make_bursts(bursts) + (ADAPTIVE_SCAN_IDLE_MS + 1000) * 1000;
+
+    wait_stats_t waits[2]    = {0};
+    uint32_t     undercounts = 0;
+    uint16_t     rgb_ms[2]   = {0};
+
+    while (now_us < end_us) {
+        current   = halves[MASTER].next_pass_us <= halves[SLAVE].next_pass_us ? MASTER : SLAVE;
+        half_t *h = &halves[current];
+        now_us    = h->next_pass_us;
+
+        uint16_t rgb      = current == MASTER ? adaptive_scan_rgb_flush_ms() : slave_adaptive_scan_rgb_flush_ms();
+        bool     idle     = rgb == ADAPTIVE_SCAN_RGB_IDLE_MS;
+        uint32_t start_us = now_us;
+        uint32_t first_us = UINT32_MAX;
+        uint8_t  first_on = MASTER;
+        bool     changed  = take_changes(h, &h->scanned, start_us, &first_us);
+        if (current == MASTER) {
+            // The transaction reads the slave's last finished scan.
+            uint32_t visible = published[1].done_us <= start_us ? published[1].scanned : published[0].scanned;
+            while (master_read < visible) {
+                if (halves[SLAVE].changes[master_read].first) {
+                    first_us = halves[SLAVE].changes[master_read].time_us;
+                    first_on = SLAVE;
+                }
+                master_read++;
+                changed = true;
+            }
+        }
+        now_us += h->pass_us * random_between(75, 125) / 100;
+        if (current == SLAVE) {
+            published[0] = published[1];
+            published[1] = (typeof(published[1])){h->scanned, now_us};
+        } else {
+            // SPLIT_ACTIVITY_ENABLE hands the master's timestamp to the slave.
+            halves[SLAVE].activity_ms = MAX(halves[SLAVE].activity_ms, h->activity_ms);
+        }
+        if (changed) {
+            h->activity_ms = timer_read32();
+        }
+        uint32_t pass_end_us = now_us;
+
+        h->next_pass_us = now_us;
+        logged_wait_us  = 0;
+        if (current == MASTER) {
+            adaptive_scan_task();
+        } else {
+            slave_adaptive_scan_task();
+        }
+
+        if (current == MASTER && first_us != UINT32_MAX) {
+            wait_stats_t *w = &waits[first_on];
+            uint32_t      waited_us = pass_end_us - first_us;
+            w->keys++;
+            w->total_us += waited_us;
+            w->max_us = MAX(w->max_us, waited_us);
+            w->woken += logged_wait_us > 0;
+            undercounts += first_on == MASTER && logged_wait_us < waited_us;
+        }
+        h->busy_us[idle] += pass_end_us - start_us;
+        h->wall_us[idle] += h->next_pass_us - start_us;
+        h->passes[idle]++;
+        rgb_ms[idle] = rgb;
+    }
+
+    // Each half owes half the period, or two of its passes when those are longer.
+    uint32_t limit_us = 0;
+    for (uint8_t half = MASTER; half <= SLAVE; half++) {
+        limit_us += MAX(ADAPTIVE_SCAN_PERIOD_US / 2, 2 * halves[half].pass_us * 125 / 100);
+    }
+    bool ok = true;
+    printf("loop          master pass %u us, slave %u us, +-25%%; wake within %u us\n", halves[MASTER].pass_us, halves[SLAVE].pass_us, limit_us);
+    print_half("master", &halves[MASTER]);
+    print_half("slave", &halves[SLAVE]);
+    printf("rgb flush     %u ms active, %u ms idle\n", rgb_ms[0], rgb_ms[1]);
+    for (uint8_t half = MASTER; half <= SLAVE; half++) {
+        const wait_stats_t *w = &waits[half];
+        printf("%s keys   %3u bursts, first key waited mean %4.0f us, max %4u us", half == MASTER ? "master" : "slave ", w->keys, w->keys ? (double)w->total_us / w->keys : 0, w->max_us);
+        if (w->max_us > limit_us) {
+            printf("  TOO LATE");
+            ok = false;
+        }
+        if (w->woken != w->keys) {
+            printf("  %u NOT FROM IDLE", w->keys - w->woken);
+            ok = false;
+        }
+        printf("\n");
+    }
+    if (waits[MASTER].keys + waits[SLAVE].keys != bursts) {
+        printf("bursts        %u of %u seen\n", waits[MASTER].keys + waits[SLAVE].keys, bursts);
+        ok = false;
+    }
+    if (undercounts) {
+        printf("logged wait   shorter than the real one %u times\n", undercounts);
+        ok = false;
+    }
+    printf("result        %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
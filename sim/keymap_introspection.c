@@ -0,0 +1,56 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Same trick as quantum/keymap_introspection.c: pull the keymap in as part of
+ * this translation unit so the sizes of its arrays are visible.
+ */
+
+#include KEYMAP_C
+
+uint8_t keymap_layer_count(void) {
+    return sizeof(keymaps) / sizeof(keymaps[0]);
+}
+
+uint16_t keycode_at_keymap_location_raw(uint8_t layer, uint8_t row, uint8_t col) {
+    if (layer < keymap_layer_count() && row < MATRIX_ROWS && col < MATRIX_COLS) {
+        return keymaps[layer][row][col];
+    }
+    return KC_TRNS;
+}
+
+// Overridden by a remappable keymap, as dynamic_keymap.c does in the core.
+__attribute__((weak)) uint16_t keycode_at_keymap_location(uint8_t layer, uint8_t row, uint8_t col) {
+    return keycode_at_keymap_location_raw(layer, row, col);
+}
+
+#ifdef COMBO_ENABLE
+uint16_t combo_count(void) {
+    return sizeof(key_combos) / sizeof(key_combos[0]);
+}
+
+combo_t *combo_get(uint16_t combo_idx) {
+    return &key_combos[combo_idx];
+}
+#else
+uint16_t combo_count(void) {
+    return 0;
+}
+
+combo_t *combo_get(uint16_t combo_idx) {
+    return NULL;
+}
+#endif
@@ -0,0 +1,487 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include QMK_KEYBOARD_H
+
+/*
+ * Layers, keycode actions and keyboard report generation. This is the part of
+ * the core that runs once a record has left the combo and tap-hold buffers.
+ */
+
+layer_state_t layer_state         = 0;
+layer_state_t default_layer_state = 1;
+
+static uint8_t           real_mods;
+static uint8_t           weak_mods;
+static uint8_t           oneshot_mods;
+static bool              oneshot_interrupted;
+static bool              caps_word_active;
+static uint8_t           source_layer[MATRIX_ROWS][MATRIX_COLS];
+static report_keyboard_t report;
+static report_keyboard_t last_report;
+
+__attribute__((weak)) layer_state_t layer_state_set_user(layer_state_t state) {
+    return state;
+}
+
+__attribute__((weak)) layer_state_t default_layer_state_set_user(layer_state_t state) {
+    return state;
+}
+
+__attribute__((weak)) bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+__attribute__((weak)) bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+__attribute__((weak)) void post_process_record_user(uint16_t keycode, keyrecord_t *record) {}
+
+/* Layers */
+
+static void layer_state_set(layer_state_t state) {
+    layer_state = layer_state_set_user(state);
+}
+
+void layer_on(uint8_t layer) {
+    layer_state_set(layer_state | ((layer_state_t)1 << layer));
+}
+
+void layer_off(uint8_t layer) {
+    layer_state_set(layer_state & ~((layer_state_t)1 << layer));
+}
+
+void layer_move(uint8_t layer) {
+    layer_state_set((layer_state_t)1 << layer);
+}
+
+void layer_clear(void) {
+    layer_state_set(0);
+}
+
+bool layer_state_cmp(layer_state_t state, uint8_t layer) {
+    if (!state) {
+        return layer == 0;
+    }
+    return (state & ((layer_state_t)1 << layer)) != 0;
+}
+
+bool layer_state_is(uint8_t layer) {
+    return layer_state_cmp(layer_state, layer);
+}
+
+uint8_t get_highest_layer(layer_state_t state) {
+    uint8_t layer = 0;
+    while (state >>= 1) {
+        layer++;
+    }
+    return layer;
+}
+
+layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3) {
+    layer_state_t mask12 = ((layer_state_t)1 << layer1) | ((layer_state_t)1 << layer2);
+    layer_state_t mask3  = (layer_state_t)1 << layer3;
+    return (state & mask12) == mask12 ? (state | mask3) : (state & ~mask3);
+}
+
+void default_layer_set(layer_state_t state) {
+    default_layer_state = default_layer_state_set_user(state);
+}
+
+void set_single_persistent_default_layer(uint8_t default_layer) {
+    eeconfig_update_default_layer((uint32_t)1 << default_layer);
+    default_layer_set((layer_state_t)1 << default_layer);
+}
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+    return keycode_at_keymap_location(layer, key.row, key.col);
+}
+
+uint8_t layer_switch_get_layer(keypos_t key) {
+    layer_state_t layers = layer_state | default_layer_state;
+    for (int8_t i = keymap_layer_count() - 1; i >= 0; i--) {
+        if (layers & ((layer_state_t)1 << i)) {
+            if (keymap_key_to_keycode(i, key) != KC_TRNS) {
+                return i;
+            }
+        }
+    }
+    return 0;
+}
+
+uint16_t sim_keycode_at(keypos_t key) {
+    return keymap_key_to_keycode(layer_switch_get_layer(key), key);
+}
+
+/* Reports */
+
+static uint8_t mod_tap_to_mod_bits(uint8_t mods) {
+    return (mods & 0x10) ? (uint8_t)((mods & 0x0F) << 4) : (mods & 0x0F);
+}
+
+void send_keyboard_report(void) {
+    report.mods = real_mods | weak_mods | oneshot_mods;
+    if (memcmp(&report, &last_report, sizeof(report)) != 0) {
+        last_report = report;
+        host_keyboard_send(&report);
+    }
+}
+
+static void add_key(uint8_t code) {
+    for (uint8_t i = 0; i < sizeof(report.keys); i++) {
+        if (report.keys[i] == code) {
+            return;
+        }
+    }
+    for (uint8_t i = 0; i < sizeof(report.keys); i++) {
+        if (report.keys[i] == KC_NO) {
+            report.keys[i] = code;
+            return;
+        }
+    }
+}
+
+static void del_key(uint8_t code) {
+    for (uint8_t i = 0; i < sizeof(report.keys); i++) {
+        if (report.keys[i] == code) {
+            report.keys[i] = KC_NO;
+        }
+    }
+}
+
+uint8_t get_mods(void) {
+    return real_mods;
+}
+
+void add_mods(uint8_t mods) {
+    real_mods |= mods;
+}
+
+void del_mods(uint8_t mods) {
+    real_mods &= ~mods;
+}
+
+void set_mods(uint8_t mods) {
+    real_mods = mods;
+}
+
+void clear_mods(void) {
+    real_mods = 0;
+}
+
+void add_weak_mods(uint8_t mods) {
+    weak_mods |= mods;
+}
+
+void del_weak_mods(uint8_t mods) {
+    weak_mods &= ~mods;
+}
+
+uint8_t get_weak_mods(void) {
+    return weak_mods;
+}
+
+void set_weak_mods(uint8_t mods) {
+    weak_mods = mods;
+}
+
+uint8_t get_oneshot_mods(void) {
+    return oneshot_mods;
+}
+
+void set_oneshot_mods(uint8_t mods) {
+    oneshot_mods = mods;
+}
+
+void register_code(uint8_t code) {
+    if (code == KC_NO) {
+        return;
+    }
+    if (IS_MODIFIER_KEYCODE(code)) {
+        real_mods |= MOD_BIT(code);
+    } else {
+        add_key(code);
+    }
+    send_keyboard_report();
+    if (!IS_MODIFIER_KEYCODE(code) && oneshot_mods) {
+        oneshot_mods = 0;
+    }
+}
+
+void unregister_code(uint8_t code) {
+    if (code == KC_NO) {
+        return;
+    }
+    if (IS_MODIFIER_KEYCODE(code)) {
+        real_mods &= ~MOD_BIT(code);
+    } else {
+        del_key(code);
+    }
+    send_keyboard_report();
+}
+
+void tap_code(uint8_t code) {
+    register_code(code);
+    unregister_code(code);
+}
+
+void register_code16(uint16_t code) {
+    if (IS_QK_MODS(code)) {
+        weak_mods |= mod_tap_to_mod_bits((code >> 8) & 0x1F);
+    }
+    register_code(code & 0xFF);
+}
+
+void unregister_code16(uint16_t code) {
+    unregister_code(code & 0xFF);
+    if (IS_QK_MODS(code)) {
+        weak_mods &= ~mod_tap_to_mod_bits((code >> 8) & 0x1F);
+        send_keyboard_report();
+    }
+}
+
+void tap_code16(uint16_t code) {
+    register_code16(code);
+    unregister_code16(code);
+}
+
+/* Send string */
+
+static uint8_t ascii_to_keycode(char c, bool *shifted) {
+    *shifted = false;
+    if (c >= 'a' && c <= 'z') {
+        return KC_A + (c - 'a');
+    }
+    if (c >= 'A' && c <= 'Z') {
+        *shifted = true;
+        return KC_A + (c - 'A');
+    }
+    if (c >= '1' && c <= '9') {
+        return KC_1 + (c - '1');
+    }
+    switch (c) {
+        case '0':
+            return KC_0;
+        case ' ':
+            return KC_SPC;
+        case '\n':
+            return KC_ENT;
+        case '\t':
+            return KC_TAB;
+        case '-':
+            return KC_MINS;
+        case '.':
+            return KC_DOT;
+        case ',':
+            return KC_COMM;
+        case '/':
+            return KC_SLSH;
+        case ';':
+            return KC_SCLN;
+        case '\'':
+            return KC_QUOT;
+    }
+    return KC_NO;
+}
+
+void send_string(const char *string) {
+    while (*string) {
+        char c = *string++;
+        if (c == SS_TAP_CODE || c == SS_DOWN_CODE || c == SS_UP_CODE) {
+            uint8_t code = (uint8_t)*string++;
+            if (c == SS_TAP_CODE) {
+                tap_code(code);
+            } else if (c == SS_DOWN_CODE) {
+                register_code(code);
+            } else {
+                unregister_code(code);
+            }
+            continue;
+        }
+        bool    shifted;
+        uint8_t code = ascii_to_keycode(c, &shifted);
+        if (shifted) {
+            register_code(KC_LSFT);
+        }
+        tap_code(code);
+        if (shifted) {
+            unregister_code(KC_LSFT);
+        }
+    }
+}
+
+/* Caps word */
+
+void caps_word_on(void) {
+    caps_word_active = true;
+}
+
+void caps_word_off(void) {
+    caps_word_active = false;
+    weak_mods &= ~MOD_BIT(KC_LSFT);
+}
+
+bool is_caps_word_on(void) {
+    return caps_word_active;
+}
+
+static void process_caps_word(uint16_t keycode, keyrecord_t *record) {
+    if (!caps_word_active || !record->event.pressed) {
+        return;
+    }
+    if (IS_QK_MOD_TAP(keycode)) {
+        if (record->tap.count == 0) {
+            return;
+        }
+        keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    if (IS_MODIFIER_KEYCODE(keycode) || IS_QK_MOMENTARY(keycode) || IS_QK_ONE_SHOT_MOD(keycode)) {
+        return;
+    }
+    weak_mods &= ~MOD_BIT(KC_LSFT);
+    if (keycode >= KC_A && keycode <= KC_Z) {
+        weak_mods |= MOD_BIT(KC_LSFT);
+    } else if (keycode == KC_MINS) {
+        weak_mods |= MOD_BIT(KC_LSFT);
+    } else if (!((keycode >= KC_1 && keycode <= KC_0) || keycode == KC_BSPC || keycode == KC_DEL)) {
+        caps_word_off();
+    }
+}
+
+/* Actions */
+
+static void process_action(uint16_t keycode, keyrecord_t *record) {
+    bool pressed = record->event.pressed;
+
+    if (IS_QK_BASIC(keycode)) {
+        if (pressed) {
+            register_code(keycode);
+        } else {
+            unregister_code(keycode);
+        }
+    } else if (IS_QK_MODS(keycode)) {
+        if (pressed) {
+            register_code16(keycode);
+        } else {
+            unregister_code16(keycode);
+        }
+    } else if (IS_QK_MOD_TAP(keycode)) {
+        uint8_t mods = mod_tap_to_mod_bits(QK_MOD_TAP_GET_MODS(keycode));
+        if (record->tap.count > 0) {
+            if (pressed) {
+                register_code(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+            } else {
+                unregister_code(QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+            }
+        } else {
+            if (pressed) {
+                real_mods |= mods;
+            } else {
+                real_mods &= ~mods;
+            }
+            send_keyboard_report();
+        }
+    } else if (IS_QK_LAYER_TAP(keycode)) {
+        uint8_t layer = QK_LAYER_TAP_GET_LAYER(keycode);
+        if (record->tap.count > 0) {
+            if (pressed) {
+                register_code(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode));
+            } else {
+                unregister_code(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode));
+            }
+        } else if (pressed) {
+            layer_on(layer);
+        } else {
+            layer_off(layer);
+        }
+    } else if (IS_QK_MOMENTARY(keycode)) {
+        if (pressed) {
+            layer_on(keycode & 0x1F);
+        } else {
+            layer_off(keycode & 0x1F);
+        }
+    } else if (IS_QK_ONE_SHOT_MOD(keycode)) {
+        uint8_t mods = mod_tap_to_mod_bits(keycode & 0x1F);
+        if (pressed) {
+            oneshot_interrupted = false;
+            real_mods |= mods;
+        } else {
+            real_mods &= ~mods;
+            if (!oneshot_interrupted) {
+                oneshot_mods |= mods;
+            }
+        }
+        send_keyboard_report();
+    } else if (IS_QK_STENO(keycode)) {
+        process_steno(keycode, record);
+    }
+}
+
+uint16_t get_record_keycode(keyrecord_t *record, bool update_layer_cache) {
+    keypos_t key = record->event.key;
+
+    if (record->keycode) {
+        return record->keycode;
+    }
+    if (!record->event.pressed) {
+        return keymap_key_to_keycode(source_layer[key.row][key.col], key);
+    }
+    uint8_t layer = layer_switch_get_layer(key);
+    if (update_layer_cache) {
+        source_layer[key.row][key.col] = layer;
+    }
+    return keymap_key_to_keycode(layer, key);
+}
+
+void process_record(keyrecord_t *record) {
+    if (record->event.type == KEY_EVENT) {
+        record->keycode = get_record_keycode(record, true);
+        if (record->event.pressed) {
+            oneshot_interrupted = true;
+        }
+
+        uint16_t deferred = (uint16_t)(timer_read() - record->event.time);
+        sim_stats.dispatched++;
+        sim_stats.defer_ms_sum += deferred;
+        if (deferred > sim_stats.defer_ms_max) {
+            sim_stats.defer_ms_max = deferred;
+        }
+    }
+
+    uint16_t keycode = record->keycode;
+    process_caps_word(keycode, record);
+    if (!process_record_user(keycode, record)) {
+        return;
+    }
+    process_action(keycode, record);
+    post_process_record_user(keycode, record);
+}
+
+void sim_action_reset(void) {
+    layer_state         = 0;
+    default_layer_state = 1;
+    real_mods           = 0;
+    weak_mods           = 0;
+    oneshot_mods        = 0;
+    caps_word_active    = false;
+    memset(source_layer, 0, sizeof(source_layer));
+    memset(&report, 0, sizeof(report));
+    memset(&last_report, 0, sizeof(last_report));
+}
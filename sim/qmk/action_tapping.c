@@ -0,0 +1,165 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim.h"
+
+/*
+ * Tap-hold resolution for mod-taps and layer-taps.
+ *
+ * While a tap-hold key is undecided every following event is held in the
+ * waiting buffer, exactly like quantum/action_tapping.c. The key resolves to
+ * a tap when it is released within TAPPING_TERM, to a hold when the term
+ * expires, and (with PERMISSIVE_HOLD) to a hold when another key is pressed
+ * and released inside it. The *_PER_KEY callbacks are honoured the same way
+ * the core does.
+ */
+
+#ifdef TAPPING_TERM_PER_KEY
+#    define GET_TAPPING_TERM(keycode, record) get_tapping_term(keycode, record)
+#else
+#    define GET_TAPPING_TERM(keycode, record) TAPPING_TERM
+#endif
+
+#if defined(PERMISSIVE_HOLD_PER_KEY)
+#    define TAP_GET_PERMISSIVE_HOLD get_permissive_hold(tapping_key.keycode, &tapping_key)
+#elif defined(PERMISSIVE_HOLD)
+#    define TAP_GET_PERMISSIVE_HOLD true
+#else
+#    define TAP_GET_PERMISSIVE_HOLD false
+#endif
+
+#if defined(HOLD_ON_OTHER_KEY_PRESS_PER_KEY)
+#    define TAP_GET_HOLD_ON_OTHER_KEY_PRESS get_hold_on_other_key_press(tapping_key.keycode, &tapping_key)
+#elif defined(HOLD_ON_OTHER_KEY_PRESS)
+#    define TAP_GET_HOLD_ON_OTHER_KEY_PRESS true
+#else
+#    define TAP_GET_HOLD_ON_OTHER_KEY_PRESS false
+#endif
+
+#define WAITING_BUFFER_SIZE 8
+
+static keyrecord_t tapping_key;
+static bool        tapping_pending;
+static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE];
+static uint8_t     waiting_buffer_count;
+
+__attribute__((weak)) uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+    return TAPPING_TERM;
+}
+
+__attribute__((weak)) bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) {
+#ifdef PERMISSIVE_HOLD
+    return true;
+#else
+    return false;
+#endif
+}
+
+__attribute__((weak)) bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) {
+    return false;
+}
+
+static bool is_tap_hold_keycode(uint16_t keycode) {
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
+}
+
+static bool same_key(keypos_t a, keypos_t b) {
+    return a.row == b.row && a.col == b.col;
+}
+
+static bool waiting_buffer_has_press(keypos_t key) {
+    for (uint8_t i = 0; i < waiting_buffer_count; i++) {
+        if (waiting_buffer[i].event.pressed && same_key(waiting_buffer[i].event.key, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void waiting_buffer_flush(void) {
+    keyrecord_t pending[WAITING_BUFFER_SIZE];
+    uint8_t     count = waiting_buffer_count;
+
+    for (uint8_t i = 0; i < count; i++) {
+        pending[i] = waiting_buffer[i];
+    }
+    waiting_buffer_count = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        action_tapping_process(pending[i]);
+    }
+}
+
+static void tapping_resolve(uint8_t tap_count) {
+    tapping_pending       = false;
+    tapping_key.tap.count = tap_count;
+    process_record(&tapping_key);
+}
+
+void action_tapping_process(keyrecord_t record) {
+    if (!tapping_pending) {
+        if (record.event.pressed && is_tap_hold_keycode(record.keycode)) {
+            tapping_key     = record;
+            tapping_pending = true;
+            return;
+        }
+        // Taps are released as soon as they resolve, so any tap-hold release
+        // reaching this point belongs to a hold.
+        record.tap.count = 0;
+        return process_record(&record);
+    }
+
+    if (!record.event.pressed && same_key(record.event.key, tapping_key.event.key)) {
+        tapping_resolve(1);
+        record.tap.count = 1;
+        process_record(&record);
+        waiting_buffer_flush();
+        return;
+    }
+
+    if (record.event.pressed && TAP_GET_HOLD_ON_OTHER_KEY_PRESS) {
+        tapping_resolve(0);
+        waiting_buffer_flush();
+        action_tapping_process(record);
+        return;
+    }
+
+    if (!record.event.pressed && waiting_buffer_has_press(record.event.key) && TAP_GET_PERMISSIVE_HOLD) {
+        tapping_resolve(0);
+        waiting_buffer_flush();
+        action_tapping_process(record);
+        return;
+    }
+
+    if (waiting_buffer_count < WAITING_BUFFER_SIZE) {
+        waiting_buffer[waiting_buffer_count++] = record;
+    }
+}
+
+void sim_tapping_task(void) {
+    if (tapping_pending && timer_elapsed(tapping_key.event.time) >= GET_TAPPING_TERM(tapping_key.keycode, &tapping_key)) {
+        tapping_resolve(0);
+        waiting_buffer_flush();
+    }
+}
+
+bool sim_tapping_idle(void) {
+    return !tapping_pending && waiting_buffer_count == 0;
+}
+
+void sim_tapping_reset(void) {
+    tapping_pending      = false;
+    waiting_buffer_count = 0;
+}
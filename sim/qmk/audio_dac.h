@@ -0,0 +1,23 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* The DAC the Planck rev7 drives its speaker from, at the core's defaults */
+
+#define AUDIO_DAC_SAMPLE_MAX 4095U
+#define AUDIO_DAC_SAMPLE_RATE 44100U
+#define AUDIO_DAC_BUFFER_SIZE 256U
@@ -0,0 +1,48 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * The rev7 matrix is 8x6: the left half of the grid lives in rows 0-3 and the
+ * right half in rows 4-7, both with columns counted from the left edge.
+ */
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 6
+
+#define SIM_BOARD_NAME "planck/rev7"
+
+/* clang-format off */
+#define LAYOUT_planck_grid( \
+    k00, k01, k02, k03, k04, k05, k40, k41, k42, k43, k44, k45, \
+    k10, k11, k12, k13, k14, k15, k50, k51, k52, k53, k54, k55, \
+    k20, k21, k22, k23, k24, k25, k60, k61, k62, k63, k64, k65, \
+    k30, k31, k32, k33, k34, k35, k70, k71, k72, k73, k74, k75  \
+) { \
+    { k00, k01, k02, k03, k04, k05 }, \
+    { k10, k11, k12, k13, k14, k15 }, \
+    { k20, k21, k22, k23, k24, k25 }, \
+    { k30, k31, k32, k33, k34, k35 }, \
+    { k40, k41, k42, k43, k44, k45 }, \
+    { k50, k51, k52, k53, k54, k55 }, \
+    { k60, k61, k62, k63, k64, k65 }, \
+    { k70, k71, k72, k73, k74, k75 }  \
+}
+/* clang-format on */
+
+#include "rgb_matrix.h"
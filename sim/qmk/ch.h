@@ -0,0 +1,35 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * The ChibiOS kernel calls the userspace makes, on a 1 MHz system tick as on
+ * the RP2040. The simulator that links them provides the clock and the
+ * sleep.
+ */
+
+#include <stdint.h>
+
+typedef uint32_t systime_t;
+typedef uint32_t sysinterval_t;
+
+#define TIME_US2I(us) ((sysinterval_t)(us))
+#define TIME_I2US(interval) ((uint32_t)(interval))
+#define chTimeDiffX(start, end) ((sysinterval_t)((systime_t)((end) - (start))))
+
+systime_t chVTGetSystemTimeX(void);
+void      chThdSleep(sysinterval_t interval);
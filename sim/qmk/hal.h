@@ -0,0 +1,38 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * The ChibiOS HAL calls the userspace makes: the general purpose timer that
+ * paces the DAC. The simulator that links them provides the timers.
+ */
+
+typedef enum {
+    GPT_UNINIT,
+    GPT_STOP,
+    GPT_READY,
+    GPT_CONTINUOUS,
+    GPT_ONESHOT,
+} gptstate_t;
+
+typedef struct {
+    gptstate_t state;
+} GPTDriver;
+
+extern GPTDriver GPTD6;
+
+void gptStopTimer(GPTDriver *gptp);
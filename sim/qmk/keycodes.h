@@ -0,0 +1,233 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * Subset of the QMK keycode space used by the jonfk keymaps.
+ *
+ * Values follow quantum/keycodes.h so that keycodes built with the mod-tap and
+ * layer macros compare equal to the ones the firmware sees. Quantum keycodes the
+ * simulator does not act on (RGB, audio, MIDI, ...) only need to be distinct.
+ */
+
+// clang-format off
+enum sim_keycodes {
+    KC_NO   = 0x0000,
+    KC_TRNS = 0x0001,
+
+    KC_A = 0x0004, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M,
+    KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z,
+    KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0,
+
+    KC_ENTER = 0x0028, KC_ESCAPE, KC_BACKSPACE, KC_TAB, KC_SPACE, KC_MINUS, KC_EQUAL,
+    KC_LEFT_BRACKET, KC_RIGHT_BRACKET, KC_BACKSLASH, KC_NONUS_HASH, KC_SEMICOLON, KC_QUOTE,
+    KC_GRAVE, KC_COMMA, KC_DOT, KC_SLASH, KC_CAPS_LOCK,
+    KC_F1, KC_F2, KC_F3, KC_F4, KC_F5, KC_F6, KC_F7, KC_F8, KC_F9, KC_F10, KC_F11, KC_F12,
+    KC_PRINT_SCREEN, KC_SCROLL_LOCK, KC_PAUSE, KC_INSERT, KC_HOME, KC_PAGE_UP, KC_DELETE,
+    KC_END, KC_PAGE_DOWN, KC_RIGHT, KC_LEFT, KC_DOWN, KC_UP,
+    KC_NUM_LOCK, KC_KP_SLASH, KC_KP_ASTERISK, KC_KP_MINUS, KC_KP_PLUS,
+
+    KC_AUDIO_MUTE = 0x00A8, KC_AUDIO_VOL_UP, KC_AUDIO_VOL_DOWN, KC_MEDIA_NEXT_TRACK,
+    KC_MEDIA_PREV_TRACK, KC_MEDIA_STOP, KC_MEDIA_PLAY_PAUSE,
+
+    KC_MS_WH_UP = 0x00D9, KC_MS_WH_DOWN, KC_MS_WH_LEFT, KC_MS_WH_RIGHT,
+
+    KC_LEFT_CTRL = 0x00E0, KC_LEFT_SHIFT, KC_LEFT_ALT, KC_LEFT_GUI,
+    KC_RIGHT_CTRL, KC_RIGHT_SHIFT, KC_RIGHT_ALT, KC_RIGHT_GUI,
+
+    QK_MODS           = 0x0100,
+    QK_MODS_MAX       = 0x1FFF,
+    QK_MOD_TAP        = 0x2000,
+    QK_MOD_TAP_MAX    = 0x3FFF,
+    QK_LAYER_TAP      = 0x4000,
+    QK_LAYER_TAP_MAX  = 0x4FFF,
+    QK_MOMENTARY      = 0x5220,
+    QK_MOMENTARY_MAX  = 0x523F,
+    QK_ONE_SHOT_MOD   = 0x52A0,
+    QK_ONE_SHOT_MOD_MAX = 0x52BF,
+
+    QK_MAGIC          = 0x7000,
+    AG_SWAP           = 0x7016,
+    AG_NORM,
+    QK_MIDI_ON        = 0x7100,
+    QK_MIDI_OFF,
+    QK_AUDIO_ON       = 0x7480,
+    QK_AUDIO_OFF,
+    QK_AUDIO_CLICKY_TOGGLE = 0x748A,
+    QK_MUSIC_ON       = 0x7490,
+    QK_MUSIC_OFF,
+    QK_MUSIC_MODE_NEXT = 0x7496,
+    QK_AUDIO_VOICE_NEXT = 0x7494,
+    QK_AUDIO_VOICE_PREVIOUS,
+    QK_STENO          = 0x74C0,
+    QK_STENO_MAX      = 0x74FF,
+    QK_UNDERGLOW_TOGGLE = 0x7820,
+    QK_UNDERGLOW_MODE_NEXT,
+    QK_UNDERGLOW_MODE_PREVIOUS,
+    QK_UNDERGLOW_HUE_UP,
+    QK_UNDERGLOW_HUE_DOWN,
+    QK_UNDERGLOW_SATURATION_UP,
+    QK_UNDERGLOW_SATURATION_DOWN,
+    QK_UNDERGLOW_VALUE_UP,
+    QK_UNDERGLOW_VALUE_DOWN,
+    QK_BOOTLOADER     = 0x7C00,
+    QK_DEBUG_TOGGLE   = 0x7C02,
+    QK_CLEAR_EEPROM   = 0x7C03,
+    QK_CAPS_WORD_TOGGLE = 0x7C73,
+
+    QK_KB             = 0x7E00,
+    QK_USER           = 0x7E40,
+    QK_USER_MAX       = 0x7FFF,
+};
+// clang-format on
+
+#define SAFE_RANGE QK_USER
+
+#define XXXXXXX KC_NO
+#define _______ KC_TRNS
+
+#define KC_ENT KC_ENTER
+#define KC_ESC KC_ESCAPE
+#define KC_BSPC KC_BACKSPACE
+#define KC_SPC KC_SPACE
+#define KC_MINS KC_MINUS
+#define KC_EQL KC_EQUAL
+#define KC_LBRC KC_LEFT_BRACKET
+#define KC_RBRC KC_RIGHT_BRACKET
+#define KC_BSLS KC_BACKSLASH
+#define KC_SCLN KC_SEMICOLON
+#define KC_QUOT KC_QUOTE
+#define KC_GRV KC_GRAVE
+#define KC_COMM KC_COMMA
+#define KC_SLSH KC_SLASH
+#define KC_CAPS KC_CAPS_LOCK
+#define KC_PGUP KC_PAGE_UP
+#define KC_PGDN KC_PAGE_DOWN
+#define KC_DEL KC_DELETE
+#define KC_RGHT KC_RIGHT
+#define KC_MUTE KC_AUDIO_MUTE
+#define KC_VOLU KC_AUDIO_VOL_UP
+#define KC_VOLD KC_AUDIO_VOL_DOWN
+#define KC_MNXT KC_MEDIA_NEXT_TRACK
+#define KC_MPRV KC_MEDIA_PREV_TRACK
+#define KC_MPLY KC_MEDIA_PLAY_PAUSE
+#define KC_LCTL KC_LEFT_CTRL
+#define KC_LSFT KC_LEFT_SHIFT
+#define KC_LALT KC_LEFT_ALT
+#define KC_LGUI KC_LEFT_GUI
+#define KC_RCTL KC_RIGHT_CTRL
+#define KC_RSFT KC_RIGHT_SHIFT
+#define KC_RALT KC_RIGHT_ALT
+#define KC_RGUI KC_RIGHT_GUI
+
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+#define MOD_RCTL 0x11
+#define MOD_RSFT 0x12
+#define MOD_RALT 0x14
+#define MOD_RGUI 0x18
+
+#define MOD_BIT(code) (1 << ((code)&0x07))
+#define MOD_MASK_CTRL (MOD_BIT(KC_LCTL) | MOD_BIT(KC_RCTL))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+#define MOD_MASK_ALT (MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT))
+#define MOD_MASK_GUI (MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI))
+#define MOD_MASK_CAG (MOD_MASK_CTRL | MOD_MASK_ALT | MOD_MASK_GUI)
+
+#define LCTL(kc) ((MOD_LCTL << 8) | (kc))
+#define LSFT(kc) ((MOD_LSFT << 8) | (kc))
+#define LALT(kc) ((MOD_LALT << 8) | (kc))
+#define LGUI(kc) ((MOD_LGUI << 8) | (kc))
+#define RALT(kc) ((MOD_RALT << 8) | (kc))
+#define S(kc) LSFT(kc)
+#define QK_MODS_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MODS_GET_BASIC_KEYCODE(kc) ((kc)&0xFF)
+
+#define KC_TILD LSFT(KC_GRV)
+#define KC_EXLM LSFT(KC_1)
+#define KC_AT LSFT(KC_2)
+#define KC_HASH LSFT(KC_3)
+#define KC_DLR LSFT(KC_4)
+#define KC_PERC LSFT(KC_5)
+#define KC_CIRC LSFT(KC_6)
+#define KC_AMPR LSFT(KC_7)
+#define KC_ASTR LSFT(KC_8)
+#define KC_LPRN LSFT(KC_9)
+#define KC_RPRN LSFT(KC_0)
+#define KC_UNDS LSFT(KC_MINS)
+#define KC_PLUS LSFT(KC_EQL)
+#define KC_LCBR LSFT(KC_LBRC)
+#define KC_RCBR LSFT(KC_RBRC)
+#define KC_PIPE LSFT(KC_BSLS)
+#define KC_COLN LSFT(KC_SCLN)
+#define KC_DQUO LSFT(KC_QUOT)
+#define KC_QUES LSFT(KC_SLSH)
+
+#define MT(mod, kc) (QK_MOD_TAP | (((mod)&0x1F) << 8) | ((kc)&0xFF))
+#define LCTL_T(kc) MT(MOD_LCTL, kc)
+#define LSFT_T(kc) MT(MOD_LSFT, kc)
+#define LALT_T(kc) MT(MOD_LALT, kc)
+#define LGUI_T(kc) MT(MOD_LGUI, kc)
+#define RCTL_T(kc) MT(MOD_RCTL, kc)
+#define RSFT_T(kc) MT(MOD_RSFT, kc)
+#define RALT_T(kc) MT(MOD_RALT, kc)
+#define RGUI_T(kc) MT(MOD_RGUI, kc)
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc)&0xFF)
+
+#define LT(layer, kc) (QK_LAYER_TAP | (((layer)&0xF) << 8) | ((kc)&0xFF))
+#define QK_LAYER_TAP_GET_LAYER(kc) (((kc) >> 8) & 0xF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc)&0xFF)
+
+#define MO(layer) (QK_MOMENTARY | ((layer)&0x1F))
+#define OSM(mod) (QK_ONE_SHOT_MOD | ((mod)&0x1F))
+
+#define IS_QK_BASIC(kc) ((kc) <= 0x00FF)
+#define IS_BASIC_KEYCODE(kc) ((kc) >= KC_A && (kc) <= 0x00A4) // KC_EXSEL
+#define IS_QK_MODS(kc) ((kc) >= QK_MODS && (kc) <= QK_MODS_MAX)
+#define IS_QK_MOD_TAP(kc) ((kc) >= QK_MOD_TAP && (kc) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(kc) ((kc) >= QK_LAYER_TAP && (kc) <= QK_LAYER_TAP_MAX)
+#define IS_QK_MOMENTARY(kc) ((kc) >= QK_MOMENTARY && (kc) <= QK_MOMENTARY_MAX)
+#define IS_QK_ONE_SHOT_MOD(kc) ((kc) >= QK_ONE_SHOT_MOD && (kc) <= QK_ONE_SHOT_MOD_MAX)
+#define IS_QK_STENO(kc) ((kc) >= QK_STENO && (kc) <= QK_STENO_MAX)
+#define IS_MODIFIER_KEYCODE(kc) ((kc) >= KC_LEFT_CTRL && (kc) <= KC_RIGHT_GUI)
+
+#define QK_BOOT QK_BOOTLOADER
+#define DB_TOGG QK_DEBUG_TOGGLE
+#define EE_CLR QK_CLEAR_EEPROM
+#define CW_TOGG QK_CAPS_WORD_TOGGLE
+#define RGB_TOG QK_UNDERGLOW_TOGGLE
+#define RGB_MOD QK_UNDERGLOW_MODE_NEXT
+#define RGB_RMOD QK_UNDERGLOW_MODE_PREVIOUS
+#define RGB_HUI QK_UNDERGLOW_HUE_UP
+#define RGB_HUD QK_UNDERGLOW_HUE_DOWN
+#define RGB_SAI QK_UNDERGLOW_SATURATION_UP
+#define RGB_SAD QK_UNDERGLOW_SATURATION_DOWN
+#define RGB_VAI QK_UNDERGLOW_VALUE_UP
+#define RGB_VAD QK_UNDERGLOW_VALUE_DOWN
+#define AU_ON QK_AUDIO_ON
+#define AU_OFF QK_AUDIO_OFF
+#define AU_NEXT QK_AUDIO_VOICE_NEXT
+#define AU_PREV QK_AUDIO_VOICE_PREVIOUS
+#define CK_TOGG QK_AUDIO_CLICKY_TOGGLE
+#define MU_ON QK_MUSIC_ON
+#define MU_OFF QK_MUSIC_OFF
+#define MU_NEXT QK_MUSIC_MODE_NEXT
+#define MI_ON QK_MIDI_ON
+#define MI_OFF QK_MIDI_OFF
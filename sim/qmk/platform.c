@@ -0,0 +1,333 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "hal.h"
+#include "raw_hid.h"
+#include "transactions.h"
+
+/*
+ * Virtual clock, USB endpoint, EEPROM and deferred execution.
+ *
+ * The keyboard endpoint is modelled as a full-speed interrupt endpoint polled
+ * once per millisecond: a report submitted while the previous one is still in
+ * flight blocks the caller until the next frame, as host_keyboard_send() does
+ * on ChibiOS. That blocking time is accounted as scan-loop stall.
+ */
+
+#define USB_FRAME_MS 1
+#define MAX_DEFERRED_EXECUTORS 8
+#define CONSOLE_BUFFER_SIZE 256
+#ifdef EECONFIG_USER_DATA_SIZE
+#    define USER_DATABLOCK_SIZE EECONFIG_USER_DATA_SIZE
+#else
+#    define USER_DATABLOCK_SIZE 256
+#endif
+
+sim_stats_t        sim_stats;
+sim_report_hook_t  sim_report_hook;
+sim_steno_hook_t   sim_steno_hook;
+sim_console_hook_t sim_console_hook;
+keymap_config_t    keymap_config;
+
+static uint32_t now_ms;
+static uint32_t usb_busy_until;
+static uint32_t last_matrix_activity;
+static uint8_t  console_buffer[CONSOLE_BUFFER_SIZE];
+static uint16_t console_length;
+static bool     eeprom_valid;
+static uint16_t eeprom_keymap;
+static uint32_t eeprom_default_layer;
+static uint8_t  user_datablock[USER_DATABLOCK_SIZE];
+
+typedef struct {
+    deferred_token         token;
+    uint32_t               trigger_time;
+    deferred_exec_callback callback;
+    void                  *cb_arg;
+} deferred_executor_t;
+
+static deferred_executor_t executors[MAX_DEFERRED_EXECUTORS];
+static deferred_token      last_token;
+
+__attribute__((weak)) void keyboard_post_init_user(void) {}
+__attribute__((weak)) void matrix_scan_user(void) {}
+__attribute__((weak)) void housekeeping_task_user(void) {}
+
+/* Clock */
+
+void sim_set_time(uint32_t ms) {
+    // Time spent blocked on USB cannot be undone by the trace.
+    if (ms > now_ms) {
+        now_ms = ms;
+    }
+}
+
+uint32_t sim_time(void) {
+    return now_ms;
+}
+
+uint16_t timer_read(void) {
+    return (uint16_t)now_ms;
+}
+
+uint32_t timer_read32(void) {
+    return now_ms;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return now_ms - last;
+}
+
+uint32_t last_matrix_activity_time(void) {
+    return last_matrix_activity;
+}
+
+uint32_t last_matrix_activity_elapsed(void) {
+    return now_ms - last_matrix_activity;
+}
+
+/* USB */
+
+void host_keyboard_send(const report_keyboard_t *report) {
+    if (now_ms < usb_busy_until) {
+        sim_stats.stall_ms += usb_busy_until - now_ms;
+        now_ms = usb_busy_until;
+    }
+    usb_busy_until = now_ms + USB_FRAME_MS;
+    sim_stats.reports++;
+    if (sim_report_hook) {
+        sim_report_hook(now_ms, report);
+    }
+}
+
+int8_t sendchar(uint8_t c) {
+    if (console_length == CONSOLE_BUFFER_SIZE) {
+        return -1;
+    }
+    console_buffer[console_length++] = c;
+    return 0;
+}
+
+static void console_flush(void) {
+    if (console_length && sim_console_hook) {
+        sim_console_hook(now_ms, console_buffer, console_length);
+    }
+    console_length = 0;
+}
+
+/* EEPROM */
+
+bool eeconfig_is_enabled(void) {
+    return eeprom_valid;
+}
+
+void eeconfig_init(void) {
+    eeprom_valid = true;
+    sim_stats.eeprom_writes++;
+}
+
+// Like eeprom_update_*(), a write only happens when the value changes.
+
+uint16_t eeconfig_read_keymap(void) {
+    return eeprom_keymap;
+}
+
+void eeconfig_update_keymap(uint16_t val) {
+    if (val != eeprom_keymap) {
+        eeprom_keymap = val;
+        sim_stats.eeprom_writes++;
+    }
+}
+
+uint32_t eeconfig_read_default_layer(void) {
+    return eeprom_default_layer;
+}
+
+void eeconfig_update_default_layer(uint32_t val) {
+    if (val != eeprom_default_layer) {
+        eeprom_default_layer = val;
+        sim_stats.eeprom_writes++;
+    }
+}
+
+void eeconfig_read_user_datablock(void *data, uint32_t offset, uint32_t length) {
+    if (offset + length <= USER_DATABLOCK_SIZE) {
+        memcpy(data, user_datablock + offset, length);
+    }
+}
+
+void eeconfig_update_user_datablock(const void *data, uint32_t offset, uint32_t length) {
+    if (offset + length <= USER_DATABLOCK_SIZE && memcmp(user_datablock + offset, data, length) != 0) {
+        memcpy(user_datablock + offset, data, length);
+        sim_stats.eeprom_writes++;
+    }
+}
+
+/* Raw HID */
+
+void raw_hid_send(uint8_t *data, uint8_t length) {
+    (void)data;
+    (void)length;
+}
+
+/* Audio: nothing to play on the host, and a DAC timer that only keeps its state */
+
+void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat) {
+    (void)np;
+    (void)n_count;
+    (void)n_repeat;
+}
+
+uint8_t audio_get_number_of_active_tones(void) {
+    return 0;
+}
+
+float audio_get_processed_frequency(uint8_t tone_index) {
+    (void)tone_index;
+    return 0;
+}
+
+bool audio_is_playing_melody(void) {
+    return false;
+}
+
+GPTDriver GPTD6;
+
+void audio_driver_start(void) {
+    GPTD6.state = GPT_CONTINUOUS;
+}
+
+void gptStopTimer(GPTDriver *gptp) {
+    gptp->state = GPT_READY;
+}
+
+/* Split transport: the trace replays run the master half alone, sim/split.c models both */
+
+bool is_keyboard_master(void) {
+    return true;
+}
+
+bool is_transport_connected(void) {
+    return false;
+}
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback) {
+    (void)transaction_id;
+    (void)callback;
+}
+
+bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    (void)transaction_id;
+    (void)initiator2target_buffer_size;
+    (void)initiator2target_buffer;
+    (void)target2initiator_buffer_size;
+    (void)target2initiator_buffer;
+    return false;
+}
+
+/* Deferred execution */
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+    if (delay_ms == 0 || !callback) {
+        return INVALID_DEFERRED_TOKEN;
+    }
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        if (executors[i].token == INVALID_DEFERRED_TOKEN) {
+            if (++last_token == INVALID_DEFERRED_TOKEN) {
+                ++last_token;
+            }
+            executors[i] = (deferred_executor_t){last_token, now_ms + delay_ms, callback, cb_arg};
+            return last_token;
+        }
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+    for (uint8_t i = 0; token != INVALID_DEFERRED_TOKEN && i < MAX_DEFERRED_EXECUTORS; i++) {
+        if (executors[i].token == token) {
+            executors[i].token = INVALID_DEFERRED_TOKEN;
+            return true;
+        }
+    }
+    return false;
+}
+
+void sim_deferred_task(void) {
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        deferred_executor_t *e = &executors[i];
+        if (e->token != INVALID_DEFERRED_TOKEN && (int32_t)(now_ms - e->trigger_time) >= 0) {
+            uint32_t delay = e->callback(e->trigger_time, e->cb_arg);
+            if (delay) {
+                e->trigger_time += delay;
+            } else {
+                e->token = INVALID_DEFERRED_TOKEN;
+            }
+        }
+    }
+}
+
+/* Lifecycle */
+
+void sim_reset(void) {
+    now_ms               = 0;
+    usb_busy_until       = 0;
+    last_matrix_activity = 0;
+    console_length       = 0;
+    eeprom_valid         = false;
+    eeprom_keymap        = 0;
+    eeprom_default_layer = 1;
+    last_token           = 0;
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    memset(executors, 0, sizeof(executors));
+    memset(user_datablock, 0, sizeof(user_datablock));
+    keymap_config.raw = 0;
+    sim_action_reset();
+    sim_tapping_reset();
+    sim_combo_reset();
+    sim_steno_reset();
+    sim_rgb_reset();
+    keyboard_post_init_user();
+}
+
+void sim_matrix_event(uint8_t row, uint8_t col, bool pressed) {
+    keyrecord_t record = {
+        .event = {.key = {.col = col, .row = row}, .time = timer_read(), .type = KEY_EVENT, .pressed = pressed},
+    };
+    last_matrix_activity = now_ms;
+    sim_combo_process(&record);
+}
+
+void sim_task(void) {
+    sim_combo_task();
+    sim_tapping_task();
+    matrix_scan_user();
+    sim_deferred_task();
+    housekeeping_task_user();
+    sim_rgb_task();
+    console_flush();
+}
+
+bool sim_idle(void) {
+    return sim_combo_idle() && sim_tapping_idle();
+}
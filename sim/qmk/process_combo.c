@@ -0,0 +1,206 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim.h"
+
+/*
+ * Combo detection, ahead of tap-hold like pre_process_record_quantum.
+ *
+ * A press whose keycode is part of any combo is buffered until either every
+ * key of a combo is down (the combo fires and the keys are consumed), the
+ * pressed set stops matching any combo, a buffered key is released, or
+ * COMBO_TERM expires. Non-combo keys dump the buffer and pass straight on.
+ */
+
+#define COMBO_BUFFER_SIZE 4
+#define COMBO_MAX_KEYS 4
+
+static keyrecord_t key_buffer[COMBO_BUFFER_SIZE];
+static uint8_t     key_buffer_count;
+static uint16_t    buffer_start;
+
+static int16_t  active_combo = -1;
+static keypos_t active_keys[COMBO_MAX_KEYS];
+static uint8_t  active_key_count;
+
+__attribute__((weak)) void process_combo_event(uint16_t combo_index, bool pressed) {}
+
+static void forward(keyrecord_t record) {
+    // Resolve against the layers active when the record leaves the buffer.
+    record.keycode = 0;
+    record.keycode = get_record_keycode(&record, true);
+    if (pre_process_record_user(record.keycode, &record)) {
+        action_tapping_process(record);
+    }
+}
+
+static void dump_key_buffer(void) {
+    for (uint8_t i = 0; i < key_buffer_count; i++) {
+        forward(key_buffer[i]);
+    }
+    key_buffer_count = 0;
+}
+
+static bool combo_has_key(const combo_t *combo, uint16_t keycode) {
+    for (const uint16_t *k = combo->keys; *k != COMBO_END; k++) {
+        if (*k == keycode) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_combo_key(uint16_t keycode) {
+    for (uint16_t i = 0; i < combo_count(); i++) {
+        combo_t *combo = combo_get(i);
+        if (!combo->disabled && combo_has_key(combo, keycode)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Returns true when every buffered key belongs to the combo. */
+static bool combo_covers_buffer(const combo_t *combo) {
+    for (uint8_t i = 0; i < key_buffer_count; i++) {
+        if (!combo_has_key(combo, key_buffer[i].keycode)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint8_t combo_length(const combo_t *combo) {
+    uint8_t n = 0;
+    while (combo->keys[n] != COMBO_END) {
+        n++;
+    }
+    return n;
+}
+
+static void combo_fire(uint16_t index) {
+    combo_t *combo = combo_get(index);
+
+    active_combo     = index;
+    active_key_count = 0;
+    for (uint8_t i = 0; i < key_buffer_count && i < COMBO_MAX_KEYS; i++) {
+        active_keys[active_key_count++] = key_buffer[i].event.key;
+    }
+    key_buffer_count = 0;
+
+    if (combo->keycode) {
+        keyrecord_t record = {
+            .event   = {.key = active_keys[0], .time = timer_read(), .type = COMBO_EVENT, .pressed = true},
+            .keycode = combo->keycode,
+        };
+        process_record(&record);
+    } else {
+        process_combo_event(index, true);
+    }
+}
+
+static bool combo_release(keypos_t key) {
+    if (active_combo < 0) {
+        return false;
+    }
+    for (uint8_t i = 0; i < active_key_count; i++) {
+        if (active_keys[i].row == key.row && active_keys[i].col == key.col) {
+            combo_t *combo = combo_get(active_combo);
+            if (combo->keycode) {
+                keyrecord_t record = {
+                    .event   = {.key = active_keys[0], .time = timer_read(), .type = COMBO_EVENT, .pressed = false},
+                    .keycode = combo->keycode,
+                };
+                process_record(&record);
+            } else {
+                process_combo_event(active_combo, false);
+            }
+            active_keys[i] = active_keys[--active_key_count];
+            active_combo   = -1;
+            return true;
+        }
+    }
+    return false;
+}
+
+void sim_combo_process(keyrecord_t *record) {
+    if (!record->event.pressed) {
+        if (combo_release(record->event.key)) {
+            return;
+        }
+        for (uint8_t i = 0; i < active_key_count; i++) {
+            // Remaining keys of a combo that already fired are swallowed.
+            if (active_keys[i].row == record->event.key.row && active_keys[i].col == record->event.key.col) {
+                active_keys[i] = active_keys[--active_key_count];
+                return;
+            }
+        }
+        dump_key_buffer();
+        forward(*record);
+        return;
+    }
+
+    uint16_t keycode = sim_keycode_at(record->event.key);
+    if (!is_combo_key(keycode)) {
+        dump_key_buffer();
+        forward(*record);
+        return;
+    }
+
+    if (key_buffer_count == 0) {
+        buffer_start = record->event.time;
+    }
+    if (key_buffer_count == COMBO_BUFFER_SIZE) {
+        dump_key_buffer();
+        buffer_start = record->event.time;
+    }
+    record->keycode                  = keycode;
+    key_buffer[key_buffer_count++] = *record;
+
+    bool candidate = false;
+    for (uint16_t i = 0; i < combo_count(); i++) {
+        combo_t *combo = combo_get(i);
+        if (combo->disabled || !combo_covers_buffer(combo)) {
+            continue;
+        }
+        if (combo_length(combo) == key_buffer_count) {
+            combo_fire(i);
+            return;
+        }
+        candidate = true;
+    }
+    if (!candidate) {
+        keyrecord_t last = key_buffer[--key_buffer_count];
+        dump_key_buffer();
+        sim_combo_process(&last);
+    }
+}
+
+void sim_combo_task(void) {
+    if (key_buffer_count && timer_elapsed(buffer_start) >= COMBO_TERM) {
+        dump_key_buffer();
+    }
+}
+
+bool sim_combo_idle(void) {
+    return key_buffer_count == 0;
+}
+
+void sim_combo_reset(void) {
+    key_buffer_count = 0;
+    active_combo     = -1;
+    active_key_count = 0;
+}
@@ -0,0 +1,57 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "keymap_steno.h"
+
+/*
+ * GeminiPR steno, as process_steno.c sends it over the virtual serial port.
+ *
+ * Steno keys never touch the keyboard report. Pressed keys are OR-ed into the
+ * chord and the whole stroke goes out as one six byte packet when the last
+ * steno key is released: seven key bits per byte, most significant first in
+ * STN_* order, with bit 7 set on the first byte only.
+ */
+
+static uint8_t chord[STENO_PACKET_SIZE];
+static uint8_t keys_down;
+
+void process_steno(uint16_t keycode, keyrecord_t *record) {
+    uint8_t index = keycode - STN__MIN;
+    if (keycode > STN__MAX) {
+        return;
+    }
+    if (record->event.pressed) {
+        chord[index / 7] |= 0x40 >> (index % 7);
+        keys_down++;
+        return;
+    }
+    if (keys_down && --keys_down == 0) {
+        chord[0] |= 0x80;
+        sim_stats.steno_packets++;
+        if (sim_steno_hook) {
+            sim_steno_hook(sim_time(), chord);
+        }
+        memset(chord, 0, sizeof(chord));
+    }
+}
+
+void sim_steno_reset(void) {
+    memset(chord, 0, sizeof(chord));
+    keys_down = 0;
+}
@@ -0,0 +1,266 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * Stub of the QMK core API, just large enough to compile the jonfk keymaps on
+ * the host. Semantics follow qmk_firmware closely where it matters for timing
+ * (tap-hold, combos, report generation) and are no-ops everywhere else.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "keycodes.h"
+
+#define PROGMEM
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+
+#ifndef TAPPING_TERM
+#    define TAPPING_TERM 200
+#endif
+#ifndef COMBO_TERM
+#    define COMBO_TERM 50
+#endif
+
+/* Keyboard events */
+
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+typedef enum {
+    TICK_EVENT  = 0,
+    KEY_EVENT   = 1,
+    COMBO_EVENT = 4,
+} keyevent_type_t;
+
+typedef struct {
+    keypos_t        key;
+    uint16_t        time;
+    keyevent_type_t type;
+    bool            pressed;
+} keyevent_t;
+
+typedef struct {
+    bool    interrupted : 1;
+    bool    reserved2 : 1;
+    bool    reserved1 : 1;
+    bool    reserved0 : 1;
+    uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+    keyevent_t event;
+    tap_t      tap;
+    uint16_t   keycode;
+} keyrecord_t;
+
+typedef uint8_t matrix_row_t;
+
+/* Timer */
+
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+
+#define TIMER_DIFF_16(a, b) (uint16_t)((a) - (b))
+
+uint32_t last_matrix_activity_time(void);
+uint32_t last_matrix_activity_elapsed(void);
+
+/* Layers */
+
+typedef uint32_t layer_state_t;
+
+#define MAX_LAYER 32
+
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+void          layer_on(uint8_t layer);
+void          layer_off(uint8_t layer);
+void          layer_move(uint8_t layer);
+void          layer_clear(void);
+bool          layer_state_is(uint8_t layer);
+bool          layer_state_cmp(layer_state_t state, uint8_t layer);
+uint8_t       get_highest_layer(layer_state_t state);
+uint8_t       layer_switch_get_layer(keypos_t key);
+layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3);
+void          default_layer_set(layer_state_t state);
+void          set_single_persistent_default_layer(uint8_t default_layer);
+
+layer_state_t layer_state_set_user(layer_state_t state);
+layer_state_t default_layer_state_set_user(layer_state_t state);
+
+uint8_t  keymap_layer_count(void);
+uint16_t keycode_at_keymap_location(uint8_t layer, uint8_t row, uint8_t col);
+uint16_t keycode_at_keymap_location_raw(uint8_t layer, uint8_t row, uint8_t col);
+
+/* Keycode processing */
+
+bool process_record_user(uint16_t keycode, keyrecord_t *record);
+void post_process_record_user(uint16_t keycode, keyrecord_t *record);
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record);
+void keyboard_post_init_user(void);
+void matrix_scan_user(void);
+void housekeeping_task_user(void);
+
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record);
+bool     get_permissive_hold(uint16_t keycode, keyrecord_t *record);
+bool     get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record);
+
+void register_code(uint8_t code);
+void unregister_code(uint8_t code);
+void tap_code(uint8_t code);
+void register_code16(uint16_t code);
+void unregister_code16(uint16_t code);
+void tap_code16(uint16_t code);
+
+uint8_t get_mods(void);
+void    add_mods(uint8_t mods);
+void    del_mods(uint8_t mods);
+void    set_mods(uint8_t mods);
+void    clear_mods(void);
+void    add_weak_mods(uint8_t mods);
+void    del_weak_mods(uint8_t mods);
+uint8_t get_weak_mods(void);
+void    set_weak_mods(uint8_t mods);
+uint8_t get_oneshot_mods(void);
+void    set_oneshot_mods(uint8_t mods);
+void    send_keyboard_report(void);
+
+/* Split keyboard */
+
+bool is_keyboard_master(void);
+bool is_transport_connected(void);
+
+/* Audio */
+
+#define AUDIO_MAX_SIMULTANEOUS_TONES 3
+
+void    audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat);
+uint8_t audio_get_number_of_active_tones(void);
+float   audio_get_processed_frequency(uint8_t tone_index);
+bool    audio_is_playing_melody(void);
+void    audio_driver_start(void);
+
+/* Pointing device */
+
+typedef int8_t mouse_hv_report_t;
+
+typedef struct {
+    uint8_t           buttons;
+    int8_t            x;
+    int8_t            y;
+    mouse_hv_report_t v;
+    mouse_hv_report_t h;
+} report_mouse_t;
+
+report_mouse_t pointing_device_task_user(report_mouse_t mouse_report);
+
+/* Send string */
+
+#define SS_TAP_CODE 1
+#define SS_DOWN_CODE 2
+#define SS_UP_CODE 3
+
+#define SS_LCTL(string) "\2\xe0" string "\3\xe0"
+#define SS_LSFT(string) "\2\xe1" string "\3\xe1"
+#define SS_LALT(string) "\2\xe2" string "\3\xe2"
+#define SS_LGUI(string) "\2\xe3" string "\3\xe3"
+
+void send_string(const char *string);
+#define SEND_STRING(string) send_string(string)
+
+/* Combos */
+
+#define COMBO_END 0
+
+typedef struct {
+    const uint16_t *keys;
+    uint16_t        keycode;
+    bool            disabled;
+    bool            active;
+} combo_t;
+
+#define COMBO(ck, ca) \
+    { .keys = &(ck)[0], .keycode = (ca) }
+#define COMBO_ACTION(ck) \
+    { .keys = &(ck)[0] }
+
+uint16_t combo_count(void);
+combo_t *combo_get(uint16_t combo_idx);
+void     process_combo_event(uint16_t combo_index, bool pressed);
+
+/* Caps word */
+
+void caps_word_on(void);
+void caps_word_off(void);
+bool is_caps_word_on(void);
+
+/* EEPROM */
+
+typedef union {
+    uint16_t raw;
+    struct {
+        bool swap_control_capslock : 1;
+        bool capslock_to_control : 1;
+        bool swap_lalt_lgui : 1;
+        bool swap_ralt_rgui : 1;
+        bool no_gui : 1;
+        bool swap_grave_esc : 1;
+        bool swap_backslash_backspace : 1;
+        bool nkro : 1;
+    };
+} keymap_config_t;
+
+extern keymap_config_t keymap_config;
+
+bool     eeconfig_is_enabled(void);
+void     eeconfig_init(void);
+uint16_t eeconfig_read_keymap(void);
+void     eeconfig_update_keymap(uint16_t val);
+uint32_t eeconfig_read_default_layer(void);
+void     eeconfig_update_default_layer(uint32_t val);
+void     eeconfig_read_user_datablock(void *data, uint32_t offset, uint32_t length);
+void     eeconfig_update_user_datablock(const void *data, uint32_t offset, uint32_t length);
+
+/* Deferred execution */
+
+typedef uint8_t deferred_token;
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void *cb_arg);
+
+#define INVALID_DEFERRED_TOKEN 0
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg);
+bool           cancel_deferred_exec(deferred_token token);
+
+/* Debug */
+
+#define print(s) ((void)(s))
+#define uprintf(...) ((void)0)
+#define dprintf(...) ((void)0)
+
+int8_t sendchar(uint8_t c);
@@ -0,0 +1,80 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include QMK_KEYBOARD_H
+
+led_config_t g_led_config;
+
+static RGB     leds[RGB_MATRIX_LED_COUNT];
+static uint8_t led_min;
+
+__attribute__((weak)) bool rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max) {
+    return true;
+}
+
+RGB hsv_to_rgb(HSV hsv) {
+    uint8_t region    = hsv.h / 43;
+    uint8_t remainder = (hsv.h - region * 43) * 6;
+    uint8_t p         = (hsv.v * (255 - hsv.s)) >> 8;
+    uint8_t q         = (hsv.v * (255 - ((hsv.s * remainder) >> 8))) >> 8;
+    uint8_t t         = (hsv.v * (255 - ((hsv.s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region) {
+        case 0:
+            return (RGB){hsv.v, t, p};
+        case 1:
+            return (RGB){q, hsv.v, p};
+        case 2:
+            return (RGB){p, hsv.v, t};
+        case 3:
+            return (RGB){p, q, hsv.v};
+        case 4:
+            return (RGB){t, p, hsv.v};
+        default:
+            return (RGB){hsv.v, p, q};
+    }
+}
+
+uint8_t rgb_matrix_get_val(void) {
+    return 128;
+}
+
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index >= 0 && index < RGB_MATRIX_LED_COUNT) {
+        leds[index] = (RGB){red, green, blue};
+    }
+}
+
+void sim_rgb_task(void) {
+    uint8_t led_max = MIN(led_min + RGB_MATRIX_LED_PROCESS_LIMIT, RGB_MATRIX_LED_COUNT);
+    // The effect is solid black; the indicators draw over it.
+    memset(&leds[led_min], 0, (led_max - led_min) * sizeof(RGB));
+    rgb_matrix_indicators_advanced_user(led_min, led_max);
+    led_min = led_max == RGB_MATRIX_LED_COUNT ? 0 : led_max;
+}
+
+void sim_rgb_reset(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            g_led_config.matrix_co[row][col] = row * MATRIX_COLS + col;
+        }
+    }
+    memset(leds, 0, sizeof(leds));
+    led_min = 0;
+}
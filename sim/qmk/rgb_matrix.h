@@ -0,0 +1,61 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * RGB matrix: the LED buffer and the indicator hook, rendered in slices of
+ * RGB_MATRIX_LED_PROCESS_LIMIT LEDs per scan like rgb_matrix_task. Included
+ * by the board headers once the matrix size is known; every matrix position
+ * has an LED.
+ */
+
+#ifndef RGB_MATRIX_LED_COUNT
+#    define RGB_MATRIX_LED_COUNT (MATRIX_ROWS * MATRIX_COLS)
+#endif
+#ifndef RGB_MATRIX_LED_PROCESS_LIMIT
+#    define RGB_MATRIX_LED_PROCESS_LIMIT RGB_MATRIX_LED_COUNT
+#endif
+
+#define NO_LED 255
+
+typedef struct {
+    uint8_t h;
+    uint8_t s;
+    uint8_t v;
+} HSV;
+
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} RGB;
+
+typedef struct {
+    uint8_t matrix_co[MATRIX_ROWS][MATRIX_COLS];
+} led_config_t;
+
+extern led_config_t g_led_config;
+
+#define HSV_RED 0, 255, 255
+#define HSV_ORANGE 21, 255, 255
+#define HSV_CYAN 128, 255, 255
+#define HSV_PURPLE 191, 255, 255
+
+RGB     hsv_to_rgb(HSV hsv);
+uint8_t rgb_matrix_get_val(void);
+void    rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
+bool    rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max);
@@ -0,0 +1,90 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * Simulator-only interface between the stub core and the trace runner.
+ */
+
+#include "quantum.h"
+
+typedef struct {
+    uint8_t mods;
+    uint8_t reserved;
+    uint8_t keys[6];
+} report_keyboard_t;
+
+typedef struct {
+    uint32_t reports;       // keyboard reports put on the wire
+    uint32_t stall_ms;      // time the scan loop spent blocked on the USB endpoint
+    uint32_t eeprom_writes; // eeconfig/EEPROM updates issued by the keymap
+    uint32_t steno_packets; // GeminiPR strokes sent on the virtual serial port
+    uint32_t dispatched;    // key records that reached process_record
+    uint32_t defer_ms_sum;  // total time those records spent in the combo/tap buffers
+    uint32_t defer_ms_max;
+} sim_stats_t;
+
+#define STENO_PACKET_SIZE 6
+
+typedef void (*sim_report_hook_t)(uint32_t time, const report_keyboard_t *report);
+typedef void (*sim_steno_hook_t)(uint32_t time, const uint8_t packet[STENO_PACKET_SIZE]);
+typedef void (*sim_console_hook_t)(uint32_t time, const uint8_t *data, uint16_t length);
+
+extern sim_stats_t        sim_stats;
+extern sim_report_hook_t  sim_report_hook;
+extern sim_steno_hook_t   sim_steno_hook;
+extern sim_console_hook_t sim_console_hook;
+
+/* Clock */
+void     sim_set_time(uint32_t ms);
+uint32_t sim_time(void);
+
+/* Lifecycle */
+void sim_reset(void);
+void sim_matrix_event(uint8_t row, uint8_t col, bool pressed);
+void sim_task(void);
+bool sim_idle(void);
+
+/* Pipeline stages, in the order a key event traverses them */
+void sim_combo_process(keyrecord_t *record);
+void sim_combo_task(void);
+bool sim_combo_idle(void);
+void sim_combo_reset(void);
+
+void action_tapping_process(keyrecord_t record);
+void sim_tapping_task(void);
+bool sim_tapping_idle(void);
+void sim_tapping_reset(void);
+
+void process_record(keyrecord_t *record);
+void sim_action_reset(void);
+
+void process_steno(uint16_t keycode, keyrecord_t *record);
+void sim_steno_reset(void);
+
+/* Keymap */
+uint16_t sim_keycode_at(keypos_t key);
+uint16_t get_record_keycode(keyrecord_t *record, bool update_layer_cache);
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
+
+void sim_rgb_task(void);
+void sim_rgb_reset(void);
+
+/* Platform */
+void sim_deferred_task(void);
+void sim_platform_reset(void);
+void host_keyboard_send(const report_keyboard_t *report);
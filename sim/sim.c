@@ -0,0 +1,256 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Trace replay driver.
+ *
+ * A trace is a text file with one matrix event per line:
+ *
+ *     <time_ms> <row> <col> <d|u>
+ *
+ * Blank lines and lines starting with '#' are ignored. Events are replayed
+ * through the stub core with one scan tick per millisecond in between, and
+ * every keyboard report is printed with the virtual time it left the
+ * keyboard. The host time spent handling each event is measured over
+ * several runs so regressions in the keymap hot path show up as numbers.
+ * Console output, the TLOG records, is printed as hex for util/tlog.py -.
+ * With -H, the heatmap after the first replay is written in the format of
+ * util/heatmap.py --dump, through the same raw HID requests.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim.h"
+#include QMK_KEYBOARD_H
+#include "raw_hid.h"
+#ifdef HEATMAP_ENABLE
+#    include "heatmap.h"
+#endif
+
+#define MAX_EVENTS 65536
+#define DRAIN_MS (TAPPING_TERM + COMBO_TERM + 10)
+
+typedef struct {
+    uint32_t time;
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+} trace_event_t;
+
+static trace_event_t events[MAX_EVENTS];
+static uint32_t      event_count;
+static uint64_t     *costs;
+static bool          quiet;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_report(uint32_t time, const report_keyboard_t *report) {
+    printf("%8u  report  mods=%02x keys=%02x %02x %02x %02x %02x %02x\n", time, report->mods, report->keys[0], report->keys[1], report->keys[2], report->keys[3], report->keys[4], report->keys[5]);
+}
+
+static void print_steno(uint32_t time, const uint8_t packet[STENO_PACKET_SIZE]) {
+    printf("%8u  steno   %02x %02x %02x %02x %02x %02x\n", time, packet[0], packet[1], packet[2], packet[3], packet[4], packet[5]);
+}
+
+static void print_console(uint32_t time, const uint8_t *data, uint16_t length) {
+    printf("%8u  console", time);
+    for (uint16_t i = 0; i < length; i++) {
+        printf(" %02x", data[i]);
+    }
+    printf("\n");
+}
+
+static bool load_trace(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    char     line[256];
+    uint32_t lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\0') {
+            continue;
+        }
+        unsigned time, row, col;
+        char     dir;
+        if (sscanf(p, "%u %u %u %c", &time, &row, &col, &dir) != 4 || row >= MATRIX_ROWS || col >= MATRIX_COLS || (dir != 'd' && dir != 'u')) {
+            fprintf(stderr, "%s:%u: expected '<time_ms> <row> <col> <d|u>'\n", path, lineno);
+            fclose(f);
+            return false;
+        }
+        if (event_count && time < events[event_count - 1].time) {
+            fprintf(stderr, "%s:%u: timestamps must not go backwards\n", path, lineno);
+            fclose(f);
+            return false;
+        }
+        if (event_count == MAX_EVENTS) {
+            fprintf(stderr, "%s: more than %u events\n", path, MAX_EVENTS);
+            fclose(f);
+            return false;
+        }
+        events[event_count++] = (trace_event_t){time, row, col, dir == 'd'};
+    }
+    fclose(f);
+    return true;
+}
+
+static void run_until(uint32_t time) {
+    while (sim_time() < time) {
+        sim_set_time(sim_time() + 1);
+        sim_task();
+    }
+}
+
+static void replay(uint64_t *run_costs, bool print) {
+    sim_reset();
+    sim_report_hook  = print ? print_report : NULL;
+    sim_steno_hook   = print ? print_steno : NULL;
+    sim_console_hook = print ? print_console : NULL;
+
+    for (uint32_t i = 0; i < event_count; i++) {
+        const trace_event_t *e = &events[i];
+        run_until(e->time);
+        if (print) {
+            printf("%8u  %-6s  %u,%u\n", sim_time(), e->pressed ? "down" : "up", e->row, e->col);
+        }
+        uint64_t start = now_ns();
+        sim_matrix_event(e->row, e->col, e->pressed);
+        run_costs[i] = now_ns() - start;
+    }
+
+    uint32_t deadline = sim_time() + DRAIN_MS;
+    while (!sim_idle() && sim_time() < deadline) {
+        run_until(sim_time() + 1);
+    }
+}
+
+#ifdef HEATMAP_ENABLE
+static bool dump_heatmap(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    uint8_t packet[RAW_EPSIZE] = {HEATMAP_HID_ID, HEATMAP_HID_INFO};
+    raw_hid_receive(packet, sizeof(packet));
+    fwrite(packet, 1, sizeof(packet), f);
+
+    uint16_t size = packet[6] | packet[7] << 8;
+    for (uint16_t offset = 0; offset < size; offset += packet[1]) {
+        memset(packet, 0, sizeof(packet));
+        packet[0] = HEATMAP_HID_ID;
+        packet[1] = HEATMAP_HID_READ;
+        packet[2] = offset & 0xFF;
+        packet[3] = offset >> 8;
+        raw_hid_receive(packet, sizeof(packet));
+        fwrite(&packet[2], 1, packet[1], f);
+    }
+    return fclose(f) == 0;
+}
+#endif
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-q] [-r runs] [-H file] <trace>\n", argv0);
+    fprintf(stderr, "  -q       only print the summary\n");
+    fprintf(stderr, "  -r runs  replay the trace this many times for timing (default 100)\n");
+    fprintf(stderr, "  -H file  write the heatmap after the first replay to file, for util/heatmap.py --load\n");
+}
+
+int main(int argc, char **argv) {
+    const char *path    = NULL;
+    const char *heatmap = NULL;
+    uint32_t    runs    = 100;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            runs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-H") == 0 && i + 1 < argc) {
+            heatmap = argv[++i];
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path || runs == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (!load_trace(path)) {
+        return 1;
+    }
+
+    costs = calloc((size_t)event_count * runs + 1, sizeof(*costs));
+    if (!costs) {
+        perror("calloc");
+        return 1;
+    }
+
+    if (!quiet) {
+        printf("# %s: %s (%u events)\n", SIM_BOARD_NAME, path, event_count);
+        printf("#   t_ms  event\n");
+    }
+    replay(costs, !quiet);
+    sim_stats_t stats = sim_stats;
+#ifdef HEATMAP_ENABLE
+    if (heatmap && !dump_heatmap(heatmap)) {
+        return 1;
+    }
+#endif
+    for (uint32_t r = 1; r < runs; r++) {
+        replay(costs + (size_t)r * event_count, false);
+    }
+
+    size_t samples = (size_t)event_count * runs;
+    qsort(costs, samples, sizeof(*costs), compare_u64);
+
+    printf("board         %s\n", SIM_BOARD_NAME);
+    printf("events        %u\n", event_count);
+    printf("reports       %u\n", stats.reports);
+    printf("usb stall     %u ms\n", stats.stall_ms);
+    printf("eeprom writes %u\n", stats.eeprom_writes);
+    if (stats.steno_packets) {
+        printf("steno packets %u\n", stats.steno_packets);
+    }
+    if (stats.dispatched) {
+        printf("deferral      mean %.1f ms, max %u ms\n", (double)stats.defer_ms_sum / stats.dispatched, stats.defer_ms_max);
+    }
+    if (samples) {
+        printf("cost/event    min %llu ns, p50 %llu ns, p99 %llu ns, max %llu ns (%u runs)\n", (unsigned long long)costs[0], (unsigned long long)costs[samples / 2], (unsigned long long)costs[samples * 99 / 100], (unsigned long long)costs[samples - 1], runs);
+    }
+
+    free(costs);
+    return 0;
+}
@@ -0,0 +1,320 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Both halves of the unicorne around users/jonfk/split_sync.c.
+ *
+ * The master's layers and mods change at random, as if someone typed with
+ * layer keys and mod-taps, and split_sync_task runs once per millisecond. The
+ * split transaction loses a fraction of the frames in each direction, and the
+ * slave half can be restarted mid-run. The slave must only ever hold states
+ * the master really had, and must match the master once things settle. The
+ * bytes sent are compared with the core's SPLIT_LAYER_STATE_ENABLE and
+ * SPLIT_MODS_ENABLE transactions, which send on change and every 100 ms.
+ *
+ *     sim/build/sim_split [-n ms] [-d drop_percent] [-r restarts] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include QMK_KEYBOARD_H
+#include "split_sync.h"
+#include "transactions.h"
+
+#define MASTER 0
+#define SLAVE 1
+#define HISTORY 256
+#define CORE_SYNC_THROTTLE_MS 100
+#define CORE_LAYERS_SIZE (2 * sizeof(layer_state_t))
+#define CORE_MODS_SIZE 3
+
+typedef struct {
+    layer_state_t layers;
+    layer_state_t default_layers;
+    uint8_t       mods;
+    uint8_t       weak_mods;
+    uint8_t       oneshot_mods;
+} half_t;
+
+layer_state_t layer_state;
+layer_state_t default_layer_state;
+
+static half_t           halves[2];
+static uint8_t          current = MASTER;
+static uint8_t          mods, weak_mods, oneshot_mods;
+static uint32_t         now;
+static uint32_t         rng = 1;
+static uint32_t         drop_percent;
+static slave_callback_t slave_callback;
+
+static struct {
+    uint32_t frames;
+    uint32_t lost_frames;
+    uint32_t lost_replies;
+    uint32_t m2s_bytes;
+    uint32_t s2m_bytes;
+    uint32_t core_bytes;
+    uint32_t lag_ms;
+    uint32_t lag_max_ms;
+    uint32_t stale_states;
+} stats;
+
+/* Core stubs, acting on the half that is currently running */
+
+uint16_t timer_read(void) {
+    return (uint16_t)now;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint8_t get_mods(void) {
+    return mods;
+}
+
+void set_mods(uint8_t m) {
+    mods = m;
+}
+
+uint8_t get_weak_mods(void) {
+    return weak_mods;
+}
+
+void set_weak_mods(uint8_t m) {
+    weak_mods = m;
+}
+
+uint8_t get_oneshot_mods(void) {
+    return oneshot_mods;
+}
+
+void set_oneshot_mods(uint8_t m) {
+    oneshot_mods = m;
+}
+
+bool is_keyboard_master(void) {
+    return current == MASTER;
+}
+
+bool is_transport_connected(void) {
+    return true;
+}
+
+static void switch_to(uint8_t half) {
+    halves[current]     = (half_t){layer_state, default_layer_state, mods, weak_mods, oneshot_mods};
+    current             = half;
+    layer_state         = halves[half].layers;
+    default_layer_state = halves[half].default_layers;
+    mods                = halves[half].mods;
+    weak_mods           = halves[half].weak_mods;
+    oneshot_mods        = halves[half].oneshot_mods;
+}
+
+static uint32_t random_u32(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static bool dropped(void) {
+    return random_u32() % 100 < drop_percent;
+}
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback) {
+    slave_callback = callback;
+}
+
+bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    stats.frames++;
+    stats.m2s_bytes += initiator2target_buffer_size;
+    if (dropped()) {
+        stats.lost_frames++;
+        return false;
+    }
+    switch_to(SLAVE);
+    slave_callback(initiator2target_buffer_size, initiator2target_buffer, target2initiator_buffer_size, target2initiator_buffer);
+    switch_to(MASTER);
+    stats.s2m_bytes += target2initiator_buffer_size;
+    if (dropped()) {
+        stats.lost_replies++;
+        return false;
+    }
+    return true;
+}
+
+/* Scenario */
+
+static half_t   history[HISTORY];
+static uint32_t history_count;
+
+static bool same(const half_t *a, const half_t *b) {
+    return a->layers == b->layers && a->default_layers == b->default_layers && a->mods == b->mods && a->weak_mods == b->weak_mods && a->oneshot_mods == b->oneshot_mods;
+}
+
+static bool in_history(const half_t *state) {
+    uint32_t n = history_count < HISTORY ? history_count : HISTORY;
+    for (uint32_t i = 0; i < n; i++) {
+        if (same(&history[i], state)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void change_master(void) {
+    switch (random_u32() % 8) {
+        case 0:
+        case 1:
+        case 2:
+            layer_state ^= (layer_state_t)1 << (2 + random_u32() % 4);
+            break;
+        case 3:
+        case 4:
+            mods ^= (uint8_t)1 << (random_u32() % 8);
+            break;
+        case 5:
+            weak_mods = weak_mods ? 0 : MOD_BIT(KC_LSFT);
+            break;
+        case 6:
+            oneshot_mods = oneshot_mods ? 0 : MOD_BIT(KC_LCTL);
+            break;
+        case 7:
+            default_layer_state = (layer_state_t)1 << (random_u32() % 2);
+            break;
+    }
+}
+
+static void restart_slave(void) {
+    switch_to(SLAVE);
+    layer_state         = 0;
+    default_layer_state = 0;
+    mods = weak_mods = oneshot_mods = 0;
+    split_sync_init();
+    switch_to(MASTER);
+}
+
+static void core_sync_cost(const half_t *master) {
+    static half_t   last;
+    static uint32_t last_layers, last_mods;
+
+    if (master->layers != last.layers || master->default_layers != last.default_layers || now - last_layers >= CORE_SYNC_THROTTLE_MS) {
+        stats.core_bytes += CORE_LAYERS_SIZE;
+        last_layers = now;
+    }
+    if (master->mods != last.mods || master->weak_mods != last.weak_mods || master->oneshot_mods != last.oneshot_mods || now - last_mods >= CORE_SYNC_THROTTLE_MS) {
+        stats.core_bytes += CORE_MODS_SIZE;
+        last_mods = now;
+    }
+    last = *master;
+}
+
+static void tick(bool active, uint32_t restart_every) {
+    now++;
+    if (active && random_u32() % 150 == 0) {
+        change_master();
+    }
+    if (active && restart_every && now % restart_every == 0) {
+        restart_slave();
+    }
+
+    half_t master = {layer_state, default_layer_state, mods, weak_mods, oneshot_mods};
+    if (!history_count || !same(&history[(history_count - 1) % HISTORY], &master)) {
+        history[history_count++ % HISTORY] = master;
+    }
+    core_sync_cost(&master);
+
+    split_sync_task();
+
+    // A restarted slave legitimately holds the zero state until it resyncs.
+    half_t zero = {0};
+    if (!in_history(&halves[SLAVE]) && !same(&halves[SLAVE], &zero)) {
+        stats.stale_states++;
+    }
+    static uint32_t lag_run;
+    if (same(&halves[SLAVE], &master)) {
+        lag_run = 0;
+    } else {
+        stats.lag_ms++;
+        lag_run++;
+        stats.lag_max_ms = MAX(stats.lag_max_ms, lag_run);
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n ms] [-d drop_percent] [-r restarts] [-s seed]\n", argv0);
+    fprintf(stderr, "  -n ms            length of the run (default 60000)\n");
+    fprintf(stderr, "  -d drop_percent  frames and replies lost, each way (default 5)\n");
+    fprintf(stderr, "  -r restarts      times the slave half restarts during the run (default 2)\n");
+    fprintf(stderr, "  -s seed          random seed (default 1)\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration = 60000;
+    uint32_t restarts = 2;
+
+    drop_percent = 5;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            duration = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+            drop_percent = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            restarts = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            rng = (uint32_t)strtoul(argv[++i], NULL, 10) | 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (drop_percent >= 100) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    default_layer_state = 1;
+    switch_to(SLAVE);
+    split_sync_init();
+    switch_to(MASTER);
+    split_sync_init();
+
+    uint32_t restart_every = restarts ? duration / (restarts + 1) : 0;
+    for (uint32_t t = 0; t < duration; t++) {
+        tick(true, restart_every);
+    }
+    // Settle: no more changes, only the keepalive and retries.
+    for (uint32_t t = 0; t < 10 * SPLIT_SYNC_KEEPALIVE_MS; t++) {
+        tick(false, 0);
+    }
+
+    half_t master = {layer_state, default_layer_state, mods, weak_mods, oneshot_mods};
+    bool   ok     = same(&halves[SLAVE], &master) && stats.stale_states == 0;
+
+    printf("board         %s, master and slave halves\n", SIM_BOARD_NAME);
+    printf("duration      %u ms, %u%% lost each way, %u slave restarts\n", duration, drop_percent, restarts);
+    printf("state changes %u\n", history_count);
+    printf("frames        %u (%u lost, %u replies lost)\n", stats.frames, stats.lost_frames, stats.lost_replies);
+    printf("bytes         %u to slave, %u to master\n", stats.m2s_bytes, stats.s2m_bytes);
+    printf("core sync     %u bytes to slave\n", stats.core_bytes);
+    printf("out of sync   %u ms total, longest %u ms\n", stats.lag_ms, stats.lag_max_ms);
+    printf("stale states  %u\n", stats.stale_states);
+    printf("result        %s\n", ok ? "ok" : "MISMATCH");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * users/jonfk/keymap_store.c against a plain copy of the keymap.
+ *
+ * The compiled keymap is a made-up one shaped like the Planck's: a dense
+ * base layer and sparse layers of _______ and XXXXXXX with a few keys. Keys
+ * are remapped at random, and after each remap the keyboard restarts and
+ * the keymap decoded from the datablock must match the copy. A remap that
+ * would not fit KEYMAP_STORE_DATA_SIZE, or a keycode the encoding cannot
+ * hold, must be refused and leave the keymap alone. Some remaps are cut
+ * short after a random number of bytes reach the datablock, as by a reset
+ * mid-write: the restart must then load the keymap from before or after the
+ * remap, or the compiled one, never a mix. A corrupted byte in the stored
+ * layers and a changed compiled keymap must both load the compiled keymap,
+ * and so must a reset. Layer lights must hear of every remap and reset.
+ *
+ *     sim/build/sim_store [-n remaps] [-t torn_percent] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include QMK_KEYBOARD_H
+#include "keymap_store.h"
+
+#define LAYERS KEYMAP_STORE_LAYERS
+
+typedef uint16_t keymap_t[LAYERS][MATRIX_ROWS][MATRIX_COLS];
+
+static keymap_t builtin;
+static uint8_t  datablock[EECONFIG_USER_DATA_SIZE];
+static int32_t  write_budget = -1; // bytes the datablock still takes before the write is cut, -1 for no limit
+static uint32_t rng          = 1;
+
+static struct {
+    uint32_t remaps;
+    uint32_t refused_size;
+    uint32_t refused_keycode;
+    uint32_t torn;
+    uint32_t torn_old;
+    uint32_t torn_new;
+    uint32_t torn_builtin;
+    uint32_t mismatches;
+    uint16_t largest;
+    uint32_t lights_updates;
+} stats;
+
+/* Core stubs */
+
+uint8_t keymap_layer_count(void) {
+    return LAYERS;
+}
+
+uint16_t keycode_at_keymap_location_raw(uint8_t layer, uint8_t row, uint8_t col) {
+    return builtin[layer][row][col];
+}
+
+void eeconfig_read_user_datablock(void *data, uint32_t offset, uint32_t length) {
+    memcpy(data, datablock + offset, length);
+}
+
+void eeconfig_update_user_datablock(const void *data, uint32_t offset, uint32_t length) {
+    if (offset + length > sizeof(datablock)) {
+        stats.mismatches++;
+        return;
+    }
+    if (write_budget >= 0) {
+        length = MIN(length, (uint32_t)write_budget);
+        write_budget -= length;
+    }
+    memcpy(datablock + offset, data, length);
+}
+
+void layer_lights_keymap_changed(void) {
+    stats.lights_updates++;
+}
+
+static uint32_t random_u32(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint16_t random_keycode(void) {
+    switch (random_u32() % 8) {
+        case 0:
+        case 1:
+            return KC_TRNS;
+        case 2:
+            return KC_NO;
+        case 3:
+            return 0x8000 | random_u32(); // beyond what the encoding holds
+        default:
+            return KC_A + random_u32() % 0x7FF0;
+    }
+}
+
+static void make_builtin(void) {
+    for (uint8_t layer = 0; layer < LAYERS; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                uint32_t r = random_u32() % 100;
+                if (layer < 2) {
+                    builtin[layer][row][col] = KC_A + random_u32() % 0x60;
+                } else {
+                    builtin[layer][row][col] = r < 60 ? KC_TRNS : r < 80 ? KC_NO : KC_A + random_u32() % 0x60;
+                }
+            }
+        }
+    }
+}
+
+static void read_mirror(keymap_t mirror) {
+    for (uint8_t layer = 0; layer < LAYERS; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                mirror[layer][row][col] = keycode_at_keymap_location(layer, row, col);
+            }
+        }
+    }
+}
+
+/* Bytes the run-length encoding takes, header included, worked out separately */
+static uint16_t reference_size(const keymap_t keymap) {
+    const uint16_t *keys = &keymap[0][0][0];
+    uint16_t        size = sizeof(keymap_store_header_t);
+    for (uint16_t i = 0; i < LAYERS * MATRIX_ROWS * MATRIX_COLS;) {
+        if (keys[i] == KC_TRNS || keys[i] == KC_NO) {
+            uint16_t run = 1;
+            while (run < 64 && i + run < LAYERS * MATRIX_ROWS * MATRIX_COLS && keys[i + run] == keys[i]) {
+                run++;
+            }
+            i += run;
+            size++;
+        } else {
+            i++;
+            size += 2;
+        }
+    }
+    return size;
+}
+
+/* Restarts the keyboard and compares the keymap it loads */
+static bool restart_loads(const keymap_t expected) {
+    keymap_t mirror;
+    keymap_store_init();
+    read_mirror(mirror);
+    return memcmp(mirror, expected, sizeof(mirror)) == 0;
+}
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("mismatch      %s\n", what);
+        stats.mismatches++;
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n remaps] [-t torn_percent] [-s seed]\n", argv0);
+    fprintf(stderr, "  -n remaps        keys remapped (default 5000)\n");
+    fprintf(stderr, "  -t torn_percent  remaps cut short mid-write (default 10)\n");
+    fprintf(stderr, "  -s seed          random seed (default 1)\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t remaps       = 5000;
+    uint32_t torn_percent = 10;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            remaps = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            torn_percent = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            rng = (uint32_t)strtoul(argv[++i], NULL, 10) | 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    make_builtin();
+    check(restart_loads(builtin), "blank datablock did not load the compiled keymap");
+
+    keymap_t expected;
+    memcpy(expected, builtin, sizeof(expected));
+    for (uint32_t n = 0; n < remaps; n++) {
+        uint8_t  layer   = random_u32() % LAYERS;
+        uint8_t  row     = random_u32() % MATRIX_ROWS;
+        uint8_t  col     = random_u32() % MATRIX_COLS;
+        uint16_t keycode = random_keycode();
+        bool     torn    = random_u32() % 100 < torn_percent;
+
+        keymap_t before;
+        memcpy(before, expected, sizeof(before));
+        if (torn) {
+            write_budget = random_u32() % (keymap_store_encoded_size() + 8);
+        }
+        uint32_t updates  = stats.lights_updates;
+        bool     accepted = keymap_store_set(layer, row, col, keycode);
+        write_budget      = -1;
+        check((stats.lights_updates != updates) == (accepted && keycode != before[layer][row][col]), "layer lights not told about a remap");
+
+        if (keycode & 0x8000) {
+            check(!accepted, "keycode beyond the encoding accepted");
+            stats.refused_keycode++;
+        } else if (!accepted) {
+            // Refused for size: the remap must really not fit.
+            expected[layer][row][col] = keycode;
+            check(reference_size(expected) > KEYMAP_STORE_DATA_SIZE, "a remap that fits was refused");
+            expected[layer][row][col] = before[layer][row][col];
+            stats.refused_size++;
+        } else {
+            expected[layer][row][col] = keycode;
+            stats.remaps++;
+        }
+        stats.largest = MAX(stats.largest, keymap_store_encoded_size());
+        check(keymap_store_encoded_size() == reference_size(expected), "encoded size differs from the encoding");
+        check(keymap_store_encoded_size() <= KEYMAP_STORE_DATA_SIZE, "stored keymap outgrew KEYMAP_STORE_DATA_SIZE");
+
+        if (torn && accepted) {
+            keymap_t mirror;
+            stats.torn++;
+            keymap_store_init();
+            read_mirror(mirror);
+            if (memcmp(mirror, expected, sizeof(mirror)) == 0) {
+                stats.torn_new++;
+            } else if (memcmp(mirror, before, sizeof(mirror)) == 0) {
+                stats.torn_old++;
+            } else if (memcmp(mirror, builtin, sizeof(mirror)) == 0) {
+                stats.torn_builtin++;
+            } else {
+                check(false, "a cut-short remap loaded a mix of keymaps");
+            }
+            // Carry on from what the keyboard now holds.
+            memcpy(expected, mirror, sizeof(expected));
+        } else {
+            check(restart_loads(expected), "restart lost a remap");
+        }
+    }
+
+    // Break up the runs until the stored keymap no longer fits.
+    for (uint8_t layer = LAYERS; layer-- > 0 && !stats.refused_size;) {
+        for (uint8_t i = 0; i < MATRIX_ROWS * MATRIX_COLS; i++) {
+            uint8_t  row = i / MATRIX_COLS, col = i % MATRIX_COLS;
+            uint16_t keycode = KC_A + i;
+            if (expected[layer][row][col] != KC_TRNS && expected[layer][row][col] != KC_NO) {
+                continue;
+            }
+            if (keymap_store_set(layer, row, col, keycode)) {
+                expected[layer][row][col] = keycode;
+                continue;
+            }
+            expected[layer][row][col] = keycode;
+            check(reference_size(expected) > KEYMAP_STORE_DATA_SIZE, "a remap that fits was refused");
+            expected[layer][row][col] = keycode_at_keymap_location(layer, row, col);
+            stats.refused_size++;
+            break;
+        }
+    }
+    check(stats.refused_size > 0, "the stored keymap never filled up");
+    stats.largest = MAX(stats.largest, keymap_store_encoded_size());
+    check(restart_loads(expected), "restart lost a remap");
+
+    // A byte flipped in the stored layers
+    keymap_store_set(LAYERS - 1, 0, 0, KC_A);
+    expected[LAYERS - 1][0][0] = KC_A;
+    check(restart_loads(expected), "restart lost a remap");
+    datablock[KEYMAP_STORE_DATA_OFFSET + sizeof(keymap_store_header_t) + 1] ^= 0x04;
+    check(restart_loads(builtin), "corrupted layers were loaded");
+
+    // A firmware with a changed keymap.c
+    keymap_store_set(LAYERS - 1, 0, 0, KC_B);
+    builtin[0][0][0] ^= 1;
+    check(restart_loads(builtin), "remaps against another keymap.c were loaded");
+
+    keymap_store_set(LAYERS - 1, 0, 0, KC_C);
+    uint32_t updates = stats.lights_updates;
+    keymap_store_reset();
+    check(stats.lights_updates != updates, "layer lights not told about a reset");
+    check(restart_loads(builtin), "reset did not load the compiled keymap");
+
+    printf("keymap        %u layers of %ux%u, %u bytes stored at most of %u\n", LAYERS, MATRIX_ROWS, MATRIX_COLS, stats.largest, KEYMAP_STORE_DATA_SIZE);
+    printf("remaps        %u, %u refused as too large, %u as beyond the encoding\n", stats.remaps, stats.refused_size, stats.refused_keycode);
+    printf("cut short     %u: %u kept the old keymap, %u the new one, %u the compiled one\n", stats.torn, stats.torn_old, stats.torn_new, stats.torn_builtin);
+    printf("mismatches    %u\n", stats.mismatches);
+    printf("result        %s\n", stats.mismatches ? "FAILED" : "ok");
+    return stats.mismatches ? 1 : 0;
+}
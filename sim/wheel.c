@@ -0,0 +1,296 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * users/jonfk/timer_wheel.c against a plain list of pending timers.
+ *
+ * Every millisecond a few timers are scheduled with random delays, some of
+ * them repeating, and some pending ones are cancelled, then timer_wheel_task
+ * runs once. Each callback is checked against the list: it must be a timer
+ * that is still pending, it must not run before its trigger time, and a
+ * repeating timer must keep its own trigger times. Tokens of timers that
+ * already ran or were cancelled are kept and cancelled again, which must
+ * fail and must not touch the timer now using the entry. A delay of 0 must
+ * be refused, and a full pool must refuse until a timer frees up. After the
+ * run, with nothing more scheduled, every pending timer must run. Also
+ * reports how late callbacks ran when more than TIMER_WHEEL_MAX_CALLBACKS
+ * came due in the same pass.
+ *
+ * Then the housekeeping task stops for a few hours, as over a USB suspend,
+ * and for 30 days, past where a 32-bit difference turns negative. Every
+ * timer pending across a gap must run within a turn of the wheel, and timers
+ * scheduled after it must run as usual. Until they catch up, timers pending
+ * across a gap may run with any trigger time that is not ahead of the clock:
+ * their repeats are counted from the time they ran, and past 2^31 ms they
+ * run with the time the task woke as their trigger.
+ *
+ *     sim/build/sim_wheel [-n ms] [-r rate] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include QMK_KEYBOARD_H
+#include "timer_wheel.h"
+
+#define STALE_TOKENS 64
+#define MAX_DELAY_MS 300
+#define MAX_REPEAT_MS 100
+#define MAX_REPEATS 4
+#define LONG_GAP_MS (30 * 24 * 3600 * 1000u)
+
+typedef struct {
+    bool                pending;
+    timer_wheel_token_t token;
+    uint32_t            trigger;
+    uint32_t            repeat_ms; // 0 for a one-shot
+    uint8_t             repeats_left;
+    uint8_t             asleep; // ASLEEP pending across a gap, CATCHING_UP until it runs for a trigger after it
+} expected_t;
+
+enum { AWAKE, CATCHING_UP, ASLEEP };
+
+static expected_t            timers[TIMER_WHEEL_POOL_SIZE];
+static timer_wheel_token_t stale[STALE_TOKENS];
+static uint32_t            stale_count;
+static uint32_t            now;
+static uint32_t            rng = 1;
+static uint32_t            woke; // when the task ran again after the last gap
+
+static struct {
+    uint32_t scheduled;
+    uint32_t cancelled;
+    uint32_t fired;
+    uint32_t repeats;
+    uint32_t pool_full;
+    uint32_t late;
+    uint32_t late_max_ms;
+    uint32_t early;
+    uint32_t unexpected;
+    uint32_t stale_cancelled;
+    uint32_t gap_due;
+    uint32_t gap_late_max_ms; // after waking
+} stats;
+
+uint32_t timer_read32(void) {
+    return now;
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return now - last;
+}
+
+static uint32_t random_u32(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void forget(expected_t *t) {
+    t->pending                          = false;
+    stale[stale_count++ % STALE_TOKENS] = t->token;
+}
+
+static uint32_t fire(uint32_t trigger_time, void *cb_arg) {
+    expected_t *t = cb_arg;
+    if (t->pending && t->asleep) {
+        if (t->asleep == ASLEEP) {
+            stats.gap_late_max_ms = MAX(stats.gap_late_max_ms, now - woke);
+        }
+        t->asleep  = (int32_t)(trigger_time - woke) >= 0 ? AWAKE : CATCHING_UP;
+        t->trigger = (int32_t)(now - trigger_time) >= 0 ? trigger_time : t->trigger;
+    }
+    if (!t->pending || trigger_time != t->trigger) {
+        stats.unexpected++;
+        return 0;
+    }
+    if ((int32_t)(now - t->trigger) < 0) {
+        stats.early++;
+    } else if (now != t->trigger) {
+        stats.late++;
+        stats.late_max_ms = MAX(stats.late_max_ms, now - t->trigger);
+    }
+    stats.fired++;
+    if (t->repeats_left) {
+        t->repeats_left--;
+        t->trigger += t->repeat_ms;
+        stats.repeats++;
+        return t->repeat_ms;
+    }
+    forget(t);
+    return 0;
+}
+
+static void schedule(void) {
+    expected_t *t = NULL;
+    for (uint8_t i = 0; i < TIMER_WHEEL_POOL_SIZE && !t; i++) {
+        if (!timers[i].pending) {
+            t = &timers[i];
+        }
+    }
+    uint32_t            delay = 1 + random_u32() % MAX_DELAY_MS;
+    timer_wheel_token_t token = timer_wheel_schedule(delay, fire, t);
+    if (!t) {
+        // The pool is as big as the list, so it must be full too.
+        if (token != TIMER_WHEEL_INVALID_TOKEN) {
+            stats.unexpected++;
+        }
+        stats.pool_full++;
+        return;
+    }
+    if (token == TIMER_WHEEL_INVALID_TOKEN) {
+        stats.unexpected++;
+        return;
+    }
+    bool repeating = random_u32() % 4 == 0;
+    *t             = (expected_t){true, token, now + delay, repeating ? 1 + random_u32() % MAX_REPEAT_MS : 0, repeating ? random_u32() % (MAX_REPEATS + 1) : 0, AWAKE};
+    stats.scheduled++;
+}
+
+static void cancel(void) {
+    expected_t *t = &timers[random_u32() % TIMER_WHEEL_POOL_SIZE];
+    if (t->pending) {
+        if (!timer_wheel_cancel(t->token)) {
+            stats.unexpected++;
+        }
+        forget(t);
+        stats.cancelled++;
+    }
+}
+
+static void cancel_stale(void) {
+    if (stale_count && timer_wheel_cancel(stale[random_u32() % MIN(stale_count, STALE_TOKENS)])) {
+        stats.stale_cancelled++;
+    }
+}
+
+static uint32_t pending_count(void) {
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < TIMER_WHEEL_POOL_SIZE; i++) {
+        count += timers[i].pending;
+    }
+    return count;
+}
+
+static uint32_t asleep_count(void) {
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < TIMER_WHEEL_POOL_SIZE; i++) {
+        count += timers[i].pending && timers[i].asleep == ASLEEP;
+    }
+    return count;
+}
+
+/* Runs the task every ms until nothing is pending; false if that takes longer than any timer can. */
+static bool drain(void) {
+    for (uint32_t t = 0; t < MAX_DELAY_MS + (MAX_REPEATS + 1) * MAX_REPEAT_MS + TIMER_WHEEL_POOL_SIZE; t++) {
+        now++;
+        cancel_stale();
+        timer_wheel_task();
+    }
+    return pending_count() == 0;
+}
+
+/* Schedules a batch, sleeps through the gap and checks that the batch runs within a turn of waking. */
+static bool sleep_through(uint32_t gap_ms) {
+    for (uint8_t n = 0; n < TIMER_WHEEL_POOL_SIZE / 2; n++) {
+        schedule();
+    }
+    for (uint8_t i = 0; i < TIMER_WHEEL_POOL_SIZE; i++) {
+        timers[i].asleep = timers[i].pending ? ASLEEP : AWAKE;
+    }
+    stats.gap_due += pending_count();
+    now += gap_ms;
+    woke = now;
+    // Every timer is due; the per-pass budget spreads them over a few passes.
+    for (uint32_t t = 0; asleep_count() && t < TIMER_WHEEL_POOL_SIZE; t++, now++) {
+        timer_wheel_task();
+    }
+    bool ran = asleep_count() == 0 && drain();
+    for (uint8_t n = 0; n < TIMER_WHEEL_POOL_SIZE / 2; n++) {
+        schedule();
+    }
+    return ran && drain();
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n ms] [-r rate] [-s seed]\n", argv0);
+    fprintf(stderr, "  -n ms    length of the run (default 60000)\n");
+    fprintf(stderr, "  -r rate  timers scheduled per 100 ms (default 20)\n");
+    fprintf(stderr, "  -s seed  random seed (default 1)\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration = 60000;
+    uint32_t rate     = 20;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            duration = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            rate = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            rng = (uint32_t)strtoul(argv[++i], NULL, 10) | 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Start close to the 32-bit wrap, which the run crosses.
+    now = UINT32_MAX - duration / 2;
+    timer_wheel_init();
+    bool refused_zero = timer_wheel_schedule(0, fire, &timers[0]) == TIMER_WHEEL_INVALID_TOKEN;
+
+    uint32_t max_pending = 0;
+    for (uint32_t t = 0; t < duration; t++) {
+        now++;
+        for (uint32_t n = rate; n; n -= MIN(n, 100)) {
+            if (random_u32() % 100 < MIN(n, 100)) {
+                schedule();
+            }
+        }
+        if (random_u32() % 100 < rate / 4) {
+            cancel();
+        }
+        cancel_stale();
+        timer_wheel_task();
+        max_pending = MAX(max_pending, pending_count());
+    }
+    // Drain: longest delay plus every repeat, with budget to spare.
+    drain();
+    uint32_t left = pending_count();
+
+    uint32_t late        = stats.late;
+    uint32_t late_max_ms = stats.late_max_ms;
+    bool     woke_ok     = sleep_through(5 * 3600 * 1000u) && sleep_through(LONG_GAP_MS);
+    left += pending_count();
+
+    bool ok = refused_zero && left == 0 && woke_ok && stats.early == 0 && stats.unexpected == 0 && stats.stale_cancelled == 0;
+
+    printf("wheel         %u slots, %u timers, %u callbacks per pass\n", TIMER_WHEEL_SLOTS, TIMER_WHEEL_POOL_SIZE, TIMER_WHEEL_MAX_CALLBACKS);
+    printf("duration      %u ms, %u timers per 100 ms, up to %u ms\n", duration, rate, MAX_DELAY_MS);
+    printf("timers        %u scheduled, %u cancelled, %u refused with the pool full, at most %u pending\n", stats.scheduled, stats.cancelled, stats.pool_full, max_pending);
+    printf("callbacks     %u, of which %u repeats\n", stats.fired, stats.repeats);
+    printf("late          %u over the per-pass budget, by up to %u ms\n", late, late_max_ms);
+    printf("gaps          5 h and 30 days asleep, %u timers due, all run within %u ms of waking%s\n", stats.gap_due, stats.gap_late_max_ms, woke_ok ? "" : ", some NEVER RAN");
+    printf("delay 0       %s\n", refused_zero ? "refused" : "ACCEPTED");
+    printf("stale tokens  %u cancelled a timer\n", stats.stale_cancelled);
+    printf("errors        %u early, %u unexpected, %u never ran\n", stats.early, stats.unexpected, left);
+    printf("result        %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
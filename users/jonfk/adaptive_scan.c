@@ -0,0 +1,83 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "adaptive_scan.h"
+#include "tlog.h"
+
+#ifndef PROTOCOL_CHIBIOS
+#    error "ADAPTIVE_SCAN_ENABLE sleeps through ChibiOS"
+#endif
+
+#include <ch.h>
+
+#ifdef SPLIT_KEYBOARD
+#    define PERIOD_US (ADAPTIVE_SCAN_PERIOD_US / 2)
+#else
+#    define PERIOD_US ADAPTIVE_SCAN_PERIOD_US
+#endif
+
+static bool          idle;
+static uint32_t      seen_activity; // last_matrix_activity_time() at the previous pass
+static systime_t     pass_start;    // when the current pass left the previous sleep
+static systime_t     previous_pass_start;
+static sysinterval_t longest_pass; // since going idle
+static uint32_t      state_start;
+static uint32_t      state_passes;
+
+uint16_t adaptive_scan_rgb_flush_ms(void) {
+    return idle ? ADAPTIVE_SCAN_RGB_IDLE_MS : ADAPTIVE_SCAN_RGB_ACTIVE_MS;
+}
+
+static uint32_t passes_per_s(void) {
+    uint32_t elapsed = timer_elapsed32(state_start);
+    return elapsed ? (uint64_t)state_passes * 1000 / elapsed : 0;
+}
+
+static void enter(bool to_idle) {
+    idle         = to_idle;
+    state_start  = timer_read32();
+    state_passes = 0;
+    longest_pass = 0;
+}
+
+void adaptive_scan_task(void) {
+    systime_t now      = chVTGetSystemTimeX();
+    uint32_t  activity = last_matrix_activity_time();
+
+    state_passes++;
+    if (activity != seen_activity) {
+        seen_activity = activity;
+        if (idle) {
+            // The key moved after the previous scan read it, and this scan is done.
+            TLOG(SCAN_WAKE, timer_elapsed32(state_start), TIME_I2US(chTimeDiffX(previous_pass_start, now)), passes_per_s());
+            enter(false);
+        }
+    } else if (!idle && timer_elapsed32(activity) >= ADAPTIVE_SCAN_IDLE_MS) {
+        TLOG(SCAN_IDLE, passes_per_s());
+        enter(true);
+    }
+
+    if (idle) {
+        sysinterval_t pass   = chTimeDiffX(pass_start, now);
+        sysinterval_t period = TIME_US2I(PERIOD_US);
+        longest_pass         = MAX(longest_pass, pass);
+        if (pass + longest_pass < period) {
+            chThdSleep(period - pass - longest_pass);
+        }
+    }
+    previous_pass_start = pass_start;
+    pass_start          = chVTGetSystemTimeX();
+}
@@ -0,0 +1,48 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Adaptive scan rate for the main loop.
+ *
+ * The core scans the matrix on every pass of the main loop, thousands of
+ * times a second, whether or not a key has moved. Once the matrix has been
+ * still for ADAPTIVE_SCAN_IDLE_MS, the housekeeping task sleeps between
+ * passes instead, so that each scan ends at most ADAPTIVE_SCAN_PERIOD_US
+ * after the one before it began; the sleep leaves room for the longest pass
+ * seen while idle. A key pressed while idle is therefore seen within one
+ * period, and the first pass that sees a change goes back to full rate.
+ * While the main thread sleeps, ChibiOS runs its idle thread, which halts
+ * the core until the next interrupt when CORTEX_ENABLE_WFI_IDLE is set. RGB
+ * matrix frames are flushed every ADAPTIVE_SCAN_RGB_IDLE_MS instead of
+ * ADAPTIVE_SCAN_RGB_ACTIVE_MS while idle.
+ *
+ * On a split keyboard both halves pace themselves at half the period, so a
+ * key on the other half waits at most one paced scan there and one
+ * transaction here. SPLIT_ACTIVITY_ENABLE wakes the other half's LEDs too.
+ *
+ * Every wake logs how long the loop idled and how long before the scan that
+ * saw the key the previous one began, which is the longest the key can have
+ * waited, together with the scan rate while idle; going idle logs the rate
+ * while active. sim/build/sim_idle checks the bound on both halves of the
+ * unicorne.
+ */
+
+void     adaptive_scan_task(void);
+uint16_t adaptive_scan_rgb_flush_ms(void);
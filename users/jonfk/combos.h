@@ -0,0 +1,40 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * Combo definitions, included once from each keymap.c: QMK's keymap
+ * introspection needs key_combos in the keymap's translation unit to size it.
+ * The actions live in process_combo_event in jonfk.c.
+ *
+ * The core's process_combo already passes a key that is in no combo straight
+ * through, without buffering it; only the keys of combo_jk and caps_combo
+ * wait for COMBO_TERM. Its scan of key_combos[] cannot be replaced from
+ * userspace, and with two combos a per-key index would save next to nothing.
+ */
+
+#include "jonfk.h"
+
+#ifdef COMBO_ENABLE
+const uint16_t PROGMEM combo_jk[]   = {KC_J, KC_K, COMBO_END};
+const uint16_t PROGMEM caps_combo[] = {BR_J, BR_W, COMBO_END};
+
+combo_t key_combos[] = {
+    [ESC_COMBO]  = COMBO(combo_jk, KC_ESC),
+    [CAPS_COMBO] = COMBO_ACTION(caps_combo),
+};
+#endif
@@ -0,0 +1,266 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef PREDICTIVE_TAP_HOLD_ENABLE
+#    define PERMISSIVE_HOLD_PER_KEY
+
+/* Upper bound on the gap between two presses that still counts as typing */
+#    ifndef TYPING_STREAK_TERM
+#        define TYPING_STREAK_TERM 150
+#    endif
+#endif
+
+#ifdef TAPPING_TERM_TUNER_ENABLE
+#    define TAPPING_TERM_PER_KEY
+
+/* Bounds of the learned terms, in ms */
+#    ifndef TAPPING_TERM_TUNER_MIN
+#        define TAPPING_TERM_TUNER_MIN 100
+#    endif
+#    ifndef TAPPING_TERM_TUNER_MAX
+#        define TAPPING_TERM_TUNER_MAX 300
+#    endif
+/* Added on top of the 95th percentile tap duration */
+#    ifndef TAPPING_TERM_TUNER_MARGIN
+#        define TAPPING_TERM_TUNER_MARGIN 25
+#    endif
+/* Terms are stored in one byte per key, in steps of this many ms */
+#    ifndef TAPPING_TERM_TUNER_UNIT
+#        define TAPPING_TERM_TUNER_UNIT 4
+#    endif
+/* Taps seen on a key before its learned term replaces TAPPING_TERM */
+#    ifndef TAPPING_TERM_TUNER_MIN_SAMPLES
+#        define TAPPING_TERM_TUNER_MIN_SAMPLES 20
+#    endif
+/* Only write to EEPROM after this much typing inactivity, and at most this often */
+#    ifndef TAPPING_TERM_TUNER_IDLE_MS
+#        define TAPPING_TERM_TUNER_IDLE_MS 5000
+#    endif
+#    ifndef TAPPING_TERM_TUNER_SAVE_INTERVAL
+#        define TAPPING_TERM_TUNER_SAVE_INTERVAL 600000
+#    endif
+#endif
+
+#ifdef MACRO_QUEUE_ENABLE
+/* Pending macro keycodes, a power of two */
+#    ifndef MACRO_QUEUE_SIZE
+#        define MACRO_QUEUE_SIZE 16
+#    endif
+#endif
+
+#ifdef TIMER_WHEEL_ENABLE
+/* Timers that can be pending at once */
+#    ifndef TIMER_WHEEL_POOL_SIZE
+#        define TIMER_WHEEL_POOL_SIZE 32
+#    endif
+/* One millisecond each, a power of two; longer delays take several turns */
+#    ifndef TIMER_WHEEL_SLOTS
+#        define TIMER_WHEEL_SLOTS 64
+#    endif
+/* Callbacks run per housekeeping pass, the rest wait for the next one */
+#    ifndef TIMER_WHEEL_MAX_CALLBACKS
+#        define TIMER_WHEEL_MAX_CALLBACKS 4
+#    endif
+#endif
+
+#ifdef LATENCY_TRACE_ENABLE
+/* Records kept until the host reads them, a power of two */
+#    ifndef LATENCY_TRACE_SIZE
+#        define LATENCY_TRACE_SIZE 128
+#    endif
+#endif
+
+#ifdef SETTINGS_CACHE_ENABLE
+/* Quiet time after the last settings change before it is written to EEPROM */
+#    ifndef SETTINGS_FLUSH_DELAY
+#        define SETTINGS_FLUSH_DELAY 3000
+#    endif
+#endif
+
+#ifdef SPLIT_SYNC_ENABLE
+#    define SPLIT_TRANSACTION_IDS_USER USER_SPLIT_SYNC
+/* Sent as deltas by split_sync.c instead */
+#    undef SPLIT_LAYER_STATE_ENABLE
+#    undef SPLIT_MODS_ENABLE
+/* An unchanged state is still confirmed this often, so a restarted half catches up */
+#    ifndef SPLIT_SYNC_KEEPALIVE_MS
+#        define SPLIT_SYNC_KEEPALIVE_MS 500
+#    endif
+#endif
+
+#ifdef ADAPTIVE_SCAN_ENABLE
+/* The matrix must be still this long before the loop is paced, in ms */
+#    ifndef ADAPTIVE_SCAN_IDLE_MS
+#        define ADAPTIVE_SCAN_IDLE_MS 5000
+#    endif
+/* While paced, a key is seen at most this long after it is pressed, in us */
+#    ifndef ADAPTIVE_SCAN_PERIOD_US
+#        define ADAPTIVE_SCAN_PERIOD_US 1000
+#    endif
+/* RGB matrix flush interval while active and while paced, in ms */
+#    ifndef ADAPTIVE_SCAN_RGB_ACTIVE_MS
+#        define ADAPTIVE_SCAN_RGB_ACTIVE_MS 16
+#    endif
+#    ifndef ADAPTIVE_SCAN_RGB_IDLE_MS
+#        define ADAPTIVE_SCAN_RGB_IDLE_MS 100
+#    endif
+/* rgb_matrix_task only compares against the flush limit, so it can follow the scan state */
+#    ifndef __ASSEMBLER__
+unsigned short adaptive_scan_rgb_flush_ms(void);
+#    endif
+#    define RGB_MATRIX_LED_FLUSH_LIMIT adaptive_scan_rgb_flush_ms()
+#    ifdef SPLIT_KEYBOARD
+#        define SPLIT_ACTIVITY_ENABLE
+#    endif
+#endif
+
+#ifdef LAYER_LIGHTS_ENABLE
+/* Render a fifth of the LEDs per scan, indicators included, and flush at most every 16 ms */
+#    ifndef RGB_MATRIX_LED_PROCESS_LIMIT
+#        define RGB_MATRIX_LED_PROCESS_LIMIT ((RGB_MATRIX_LED_COUNT + 4) / 5)
+#    endif
+#    ifndef RGB_MATRIX_LED_FLUSH_LIMIT
+#        define RGB_MATRIX_LED_FLUSH_LIMIT 16
+#    endif
+#endif
+
+#ifdef ENCODER_SCROLL_ENABLE
+/* Detents closer together than this scroll more than one line */
+#    ifndef ENCODER_SCROLL_ACCEL_MS
+#        define ENCODER_SCROLL_ACCEL_MS 60
+#    endif
+/* Lines per detent at full speed */
+#    ifndef ENCODER_SCROLL_MAX_GAIN
+#        define ENCODER_SCROLL_MAX_GAIN 6
+#    endif
+/* Lines that may be waiting for a pointing device report */
+#    ifndef ENCODER_SCROLL_MAX_PENDING
+#        define ENCODER_SCROLL_MAX_PENDING 60
+#    endif
+#endif
+
+#ifdef ENCODER_NOTES_ENABLE
+/* A detent after this long at rest plays A4 again */
+#    ifndef ENCODER_NOTES_RESET_MS
+#        define ENCODER_NOTES_RESET_MS 1000
+#    endif
+#endif
+
+#ifdef WAVETABLE_AUDIO_ENABLE
+/* Scans are counted over windows this long, in ms */
+#    ifndef WAVETABLE_RATE_WINDOW_MS
+#        define WAVETABLE_RATE_WINDOW_MS 1000
+#    endif
+/* The timer whose TRGO paces the DAC additive driver's conversions, stopped while silent */
+#    ifndef WAVETABLE_DAC_TIMER
+#        define WAVETABLE_DAC_TIMER GPTD6
+#    endif
+#endif
+
+#ifdef HEATMAP_ENABLE
+/* Layers counted, from layer 0 */
+#    ifndef HEATMAP_LAYERS
+#        define HEATMAP_LAYERS 8
+#    endif
+/* Mod-tap positions whose following key is counted */
+#    ifndef HEATMAP_MOD_TAPS
+#        define HEATMAP_MOD_TAPS 16
+#    endif
+/* Longest gap after a mod-tap that still counts as a bigram, in ms */
+#    ifndef HEATMAP_BIGRAM_TERM
+#        define HEATMAP_BIGRAM_TERM 500
+#    endif
+/* Longer gaps between presses are pauses and leave the typing rate alone, in ms */
+#    ifndef HEATMAP_RATE_GAP_MS
+#        define HEATMAP_RATE_GAP_MS 2000
+#    endif
+/* Checkpoint to EEPROM at most this often, this many bytes per housekeeping pass */
+#    ifndef HEATMAP_CHECKPOINT_MS
+#        define HEATMAP_CHECKPOINT_MS 600000
+#    endif
+#    ifndef HEATMAP_CHECKPOINT_CHUNK
+#        define HEATMAP_CHECKPOINT_CHUNK 32
+#    endif
+#endif
+
+#ifdef HID_COMMAND_ENABLE
+/* Keycodes in a macro set over raw HID; one packet holds at most 13 */
+#    ifndef HID_COMMAND_MACRO_KEYS
+#        define HID_COMMAND_MACRO_KEYS 12
+#    endif
+#endif
+
+#ifdef KEYMAP_STORE_ENABLE
+/* Layers mirrored in RAM and remappable, from layer 0 */
+#    ifndef KEYMAP_STORE_LAYERS
+#        define KEYMAP_STORE_LAYERS 8
+#    endif
+#endif
+
+#ifdef TEXT_EXPANSION_ENABLE
+/* Expansions waiting on the macro queue; a power of two */
+#    ifndef TEXT_EXPANSION_QUEUE_SIZE
+#        define TEXT_EXPANSION_QUEUE_SIZE 8
+#    endif
+#endif
+
+#ifdef TLOG_ENABLE
+/* Ring buffer for encoded log records, in bytes; a power of two */
+#    ifndef TLOG_BUFFER_SIZE
+#        define TLOG_BUFFER_SIZE 128
+#    endif
+/* Records are sent once no key has changed for this long, in ms */
+#    ifndef TLOG_IDLE_MS
+#        define TLOG_IDLE_MS 100
+#    endif
+/* At most this many bytes go to the console per housekeeping pass */
+#    ifndef TLOG_DRAIN_BYTES
+#        define TLOG_DRAIN_BYTES 32
+#    endif
+#endif
+
+/* User EEPROM datablock: the tuned tapping terms, the heatmap, then the remapped keymap */
+#ifdef TAPPING_TERM_TUNER_ENABLE
+#    define TAPPING_TERM_TUNER_DATA_SIZE 64
+#else
+#    define TAPPING_TERM_TUNER_DATA_SIZE 0
+#endif
+#ifdef HEATMAP_ENABLE
+#    define HEATMAP_DATA_OFFSET TAPPING_TERM_TUNER_DATA_SIZE
+#    define HEATMAP_DATA_SIZE 1600
+#else
+#    define HEATMAP_DATA_SIZE 0
+#endif
+#ifdef KEYMAP_STORE_ENABLE
+#    define KEYMAP_STORE_DATA_OFFSET (TAPPING_TERM_TUNER_DATA_SIZE + HEATMAP_DATA_SIZE)
+#    ifndef KEYMAP_STORE_DATA_SIZE
+#        define KEYMAP_STORE_DATA_SIZE 512
+#    endif
+#else
+#    define KEYMAP_STORE_DATA_SIZE 0
+#endif
+#if TAPPING_TERM_TUNER_DATA_SIZE + HEATMAP_DATA_SIZE + KEYMAP_STORE_DATA_SIZE > 0
+#    define EECONFIG_USER_DATA_SIZE (TAPPING_TERM_TUNER_DATA_SIZE + HEATMAP_DATA_SIZE + KEYMAP_STORE_DATA_SIZE)
+/* The core's eeconfig, keyboard datablock included, takes less than this ahead of it */
+#    define EECONFIG_CORE_RESERVE 64
+#    ifndef WEAR_LEVELING_LOGICAL_SIZE
+#        error "Set WEAR_LEVELING_LOGICAL_SIZE in the keymap's config.h so the user datablock can be checked against it"
+#    elif EECONFIG_CORE_RESERVE + EECONFIG_USER_DATA_SIZE > WEAR_LEVELING_LOGICAL_SIZE
+#        error "The user EEPROM datablock does not fit WEAR_LEVELING_LOGICAL_SIZE"
+#    endif
+#endif
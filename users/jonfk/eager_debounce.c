@@ -0,0 +1,109 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Per-key debounce, eager on press and deferred on release.
+ *
+ * Replaces the core's debounce with DEBOUNCE_TYPE = custom. A key goes down
+ * on the first scan that sees its contact close, and bounces on the way
+ * down are ignored for DEBOUNCE ms after that. It goes up only once its
+ * contact has read open for DEBOUNCE ms in a row, so chatter while a key is
+ * held never turns into a release. Every key keeps its own timer; unlike
+ * the core's default sym_defer_g, one bouncing key does not hold back
+ * presses of the others. Only keys that differ from the debounced matrix
+ * or have a timer running are looked at on each scan.
+ */
+
+#include <string.h>
+
+#include QMK_KEYBOARD_H
+#include "debounce.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+_Static_assert(DEBOUNCE > 0 && DEBOUNCE < 128, "DEBOUNCE does not fit the per-key timer");
+
+typedef struct {
+    bool    pressed : 1; // timing out a press, otherwise a release
+    uint8_t time : 7;    // ms left, 0 when idle
+} debounce_counter_t;
+
+static debounce_counter_t counters[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t       active[MATRIX_ROWS]; // keys with a timer running
+static bool               counting;
+static uint16_t           last_time;
+
+void debounce_init(uint8_t num_rows) {
+    memset(counters, 0, sizeof(counters));
+    memset(active, 0, sizeof(active));
+    counting  = false;
+    last_time = timer_read();
+}
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint16_t now     = timer_read();
+    uint8_t  elapsed = MIN(TIMER_DIFF_16(now, last_time), DEBOUNCE);
+    last_time        = now;
+    if (!changed && !counting) {
+        return false;
+    }
+
+    bool cooked_changed = false;
+    counting            = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t pending = (raw[row] ^ cooked[row]) | active[row];
+        for (uint8_t col = 0; pending; col++, pending >>= 1) {
+            if (!(pending & 1)) {
+                continue;
+            }
+            matrix_row_t        bit     = (matrix_row_t)1 << col;
+            bool                differs = (raw[row] ^ cooked[row]) & bit;
+            debounce_counter_t *c       = &counters[row][col];
+
+            if (c->time) {
+                c->time = c->time > elapsed ? c->time - elapsed : 0;
+                if (!c->pressed && !differs) {
+                    // Closed again before the release was due: it was chatter.
+                    c->time = 0;
+                } else if (c->time) {
+                    counting = true;
+                    continue;
+                } else if (!c->pressed) {
+                    cooked[row] ^= bit;
+                    cooked_changed = true;
+                    differs        = false;
+                }
+                if (!c->time) {
+                    active[row] &= ~bit;
+                }
+            }
+            if (differs) {
+                if (raw[row] & bit) {
+                    cooked[row] |= bit;
+                    cooked_changed = true;
+                }
+                *c = (debounce_counter_t){.pressed = raw[row] & bit, .time = DEBOUNCE};
+                active[row] |= bit;
+                counting = true;
+            }
+        }
+    }
+    return cooked_changed;
+}
+
+void debounce_free(void) {}
@@ -0,0 +1,93 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jonfk.h"
+
+/* The tables start at A-1 so both scales share their tonic with A4 = 440 Hz */
+#define NOTE_A_1 9
+#define A_1_HZ 13.75
+
+#define NOTE_LOWEST 21  // A0
+#define NOTE_HIGHEST 108 // C8
+
+/* Folded to an integer by the compiler, nothing here runs on the keyboard */
+#define Q12(hz) ((uint32_t)((hz) * (1 << NOTE_FREQUENCY_SHIFT) + 0.5))
+#define ET12(ratio) Q12(A_1_HZ * (ratio))
+#define JUST(num, den) Q12(A_1_HZ * (num) / (den))
+
+// clang-format off
+static const uint32_t PROGMEM octave[NOTE_SCALE_COUNT][12] = {
+    [NOTE_SCALE_ET12] = {
+        ET12(1.0),                ET12(1.0594630943592953), ET12(1.122462048309373),  ET12(1.189207115002721),
+        ET12(1.2599210498948732), ET12(1.3348398541700344), ET12(1.4142135623730951), ET12(1.4983070768766815),
+        ET12(1.5874010519681994), ET12(1.681792830507429),  ET12(1.7817974362806785), ET12(1.8877486253633868),
+    },
+    [NOTE_SCALE_JUST] = {
+        JUST(1, 1),   JUST(16, 15), JUST(9, 8),   JUST(6, 5),
+        JUST(5, 4),   JUST(4, 3),   JUST(64, 45), JUST(3, 2),
+        JUST(8, 5),   JUST(5, 3),   JUST(9, 5),   JUST(15, 8),
+    },
+};
+// clang-format on
+
+static uint8_t      current      = NOTE_A4;
+static note_scale_t active_scale = NOTE_SCALE_ET12;
+static uint32_t     last_detent;
+static float        melody[2][2] = {{0, 8}, {0, 24}}; // read by the audio driver while it plays
+
+uint32_t note_frequency(uint8_t note, note_scale_t scale) {
+    if (note < NOTE_A_1) {
+        return 0;
+    }
+    uint8_t offset = note - NOTE_A_1;
+    return pgm_read_dword(&octave[scale][offset % 12]) << (offset / 12);
+}
+
+/* The audio driver takes float Hz; this is the only conversion */
+static float note_hz(uint8_t note) {
+    return (float)note_frequency(note, active_scale) / (1 << NOTE_FREQUENCY_SHIFT);
+}
+
+bool process_encoder_notes(uint16_t keycode, keyrecord_t *record) {
+    if (keycode != NOTE_UP && keycode != NOTE_DN && keycode != NOTE_TG) {
+        return true;
+    }
+    if (!record->event.pressed) {
+        return false;
+    }
+    if (keycode == NOTE_TG) {
+        active_scale = (active_scale + 1) % NOTE_SCALE_COUNT;
+        return false;
+    }
+
+    if (timer_elapsed32(last_detent) > ENCODER_NOTES_RESET_MS) {
+        current = NOTE_A4;
+    }
+    last_detent = timer_read32();
+
+    uint8_t lead;
+    if (keycode == NOTE_UP) {
+        current = MIN(current + 1, NOTE_HIGHEST);
+        lead    = current - 7;
+    } else {
+        current = MAX(current - 1, NOTE_LOWEST);
+        lead    = current + 6;
+    }
+    melody[0][0] = note_hz(lead);
+    melody[1][0] = note_hz(current);
+    audio_play_melody(&melody, 2, false);
+    return false;
+}
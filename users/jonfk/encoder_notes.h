@@ -0,0 +1,46 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Notes from an encoder, looked up in integer pitch tables.
+ *
+ * NOTE_UP/NOTE_DN go in the encoder_map. Each detent moves one semitone and
+ * plays the new note after a short lead-in a fifth below (up) or a tritone
+ * above (down); a detent after ENCODER_NOTES_RESET_MS of rest starts again
+ * from A4. NOTE_TG switches between 12-TET and just intonation on A.
+ *
+ * Pitches are MIDI note numbers. One octave of each scale is a const table of
+ * frequencies in 1/4096 Hz, folded from constants at compile time, and the
+ * other octaves are shifts of it, so stepping up and down never drifts.
+ */
+
+typedef enum {
+    NOTE_SCALE_ET12,
+    NOTE_SCALE_JUST,
+    NOTE_SCALE_COUNT,
+} note_scale_t;
+
+#define NOTE_A4 69
+#define NOTE_FREQUENCY_SHIFT 12
+
+/* Frequency of a MIDI note, A-1 (9) and up, in 1/4096 Hz */
+uint32_t note_frequency(uint8_t note, note_scale_t scale);
+
+bool process_encoder_notes(uint16_t keycode, keyrecord_t *record);
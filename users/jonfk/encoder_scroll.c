@@ -0,0 +1,65 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jonfk.h"
+
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+#    define WHEEL_UNIT POINTING_DEVICE_HIRES_SCROLL_MULTIPLIER
+#else
+#    define WHEEL_UNIT 1
+#endif
+
+#ifdef WHEEL_EXTENDED_REPORT
+#    define WHEEL_MAX INT16_MAX
+#else
+#    define WHEEL_MAX INT8_MAX
+#endif
+
+static int16_t  pending; // wheel units not reported yet, positive scrolls up
+static uint16_t last_detent;
+
+bool process_encoder_scroll(uint16_t keycode, keyrecord_t *record) {
+    if (keycode != SCRL_UP && keycode != SCRL_DN) {
+        return true;
+    }
+    if (!record->event.pressed) {
+        return false;
+    }
+
+    uint16_t elapsed = TIMER_DIFF_16(record->event.time, last_detent);
+    uint8_t  gain    = 1;
+    if (elapsed < ENCODER_SCROLL_ACCEL_MS) {
+        gain = MIN(ENCODER_SCROLL_MAX_GAIN, ENCODER_SCROLL_ACCEL_MS / MAX(elapsed, 1));
+    }
+    last_detent = record->event.time;
+
+    int16_t delta = (keycode == SCRL_UP ? 1 : -1) * gain * WHEEL_UNIT;
+    if ((delta > 0) != (pending > 0)) {
+        pending = 0;
+    }
+    // Bounded so a long fast spin cannot keep scrolling after the hand stops.
+    pending = MAX(-ENCODER_SCROLL_MAX_PENDING * WHEEL_UNIT, MIN(pending + delta, ENCODER_SCROLL_MAX_PENDING * WHEEL_UNIT));
+    return false;
+}
+
+report_mouse_t encoder_scroll_task(report_mouse_t mouse_report) {
+    if (pending) {
+        int16_t v = MAX(-WHEEL_MAX, MIN(pending, WHEEL_MAX));
+        mouse_report.v += v;
+        pending -= v;
+    }
+    return mouse_report;
+}
@@ -0,0 +1,34 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Accelerated wheel scrolling from an encoder.
+ *
+ * SCRL_UP/SCRL_DN go in the encoder_map in place of KC_MS_WH_UP/DOWN.
+ * Instead of tapping a mouse key per detent, each detent adds to a wheel
+ * delta that the next pointing device report carries, so however many
+ * detents arrive between two reports they go out as one. Detents closer
+ * together than ENCODER_SCROLL_ACCEL_MS scroll further, up to
+ * ENCODER_SCROLL_MAX_GAIN lines each, and turning back drops whatever was
+ * still pending in the old direction.
+ */
+
+bool           process_encoder_scroll(uint16_t keycode, keyrecord_t *record);
+report_mouse_t encoder_scroll_task(report_mouse_t mouse_report);
@@ -0,0 +1,53 @@
+// Generated by util/compile_expansions.py from expansions.txt, do not edit.
+// 19 expansions, 56 trie nodes stored as 56: 360 + 236 bytes
+
+#pragma once
+
+#define EXPANSION_COUNT 19
+#define EXPANSION_MAX_TRIGGER 6
+
+// clang-format off
+static const uint8_t PROGMEM expansion_trie[] = {
+    0x40, 0x2B, 0xC9, 0x48, 0x00, 0x42, 0x00, 0x55, 0x00, 0x61, 0x01, 0x6D, 0x00, 0xAC, 0x00, 0xD4,
+    0x00, 0xE7, 0x00, 0xF8, 0x00, 0x1C, 0x01, 0x2F, 0x01, 0x80, 0x66, 0x00, 0x40, 0x00, 0x04, 0x00,
+    0x00, 0x19, 0x00, 0x40, 0x00, 0x01, 0x00, 0x00, 0x1C, 0x00, 0x40, 0x01, 0x00, 0x00, 0x00, 0x23,
+    0x00, 0x80, 0x18, 0x00, 0x40, 0x00, 0x80, 0x00, 0x00, 0x31, 0x00, 0x40, 0x01, 0x00, 0x00, 0x00,
+    0x34, 0x00, 0x40, 0x20, 0x00, 0x04, 0x00, 0x2A, 0x00, 0x3B, 0x00, 0x80, 0xA2, 0x00, 0x40, 0x00,
+    0x00, 0x40, 0x00, 0x4B, 0x00, 0x40, 0x00, 0x00, 0x08, 0x00, 0x4E, 0x00, 0x80, 0x2C, 0x00, 0x40,
+    0x00, 0x00, 0x40, 0x00, 0x5C, 0x00, 0x40, 0x00, 0x01, 0x00, 0x00, 0x5F, 0x00, 0x40, 0x00, 0x00,
+    0x40, 0x00, 0x66, 0x00, 0x80, 0x00, 0x00, 0x40, 0x04, 0x00, 0x00, 0x00, 0x74, 0x00, 0x40, 0x00,
+    0x00, 0x02, 0x00, 0x77, 0x00, 0x80, 0x88, 0x00, 0xC0, 0xE8, 0x00, 0x00, 0x40, 0x00, 0x00, 0x85,
+    0x00, 0x80, 0xE3, 0x00, 0x40, 0x10, 0x00, 0x00, 0x00, 0x91, 0x00, 0x80, 0xDD, 0x00, 0x40, 0x00,
+    0x00, 0x08, 0x00, 0x9B, 0x00, 0x40, 0x00, 0x20, 0x00, 0x00, 0x9E, 0x00, 0x40, 0x00, 0x11, 0x24,
+    0x00, 0x7E, 0x00, 0x88, 0x00, 0xA5, 0x00, 0x94, 0x00, 0x80, 0x77, 0x00, 0x40, 0x00, 0x10, 0x00,
+    0x00, 0xB9, 0x00, 0x40, 0x00, 0x00, 0x08, 0x00, 0xBC, 0x00, 0x80, 0x96, 0x00, 0x40, 0x00, 0x04,
+    0x00, 0x00, 0xCA, 0x00, 0x40, 0x40, 0x10, 0x00, 0x00, 0xC3, 0x00, 0xCD, 0x00, 0x80, 0xAD, 0x00,
+    0x40, 0x00, 0x00, 0x40, 0x00, 0xDD, 0x00, 0x40, 0x00, 0x10, 0x00, 0x00, 0xE0, 0x00, 0x80, 0xC9,
+    0x00, 0x40, 0x00, 0x00, 0x04, 0x00, 0xEE, 0x00, 0x40, 0x00, 0x08, 0x00, 0x00, 0xF1, 0x00, 0x80,
+    0xD0, 0x00, 0x40, 0x00, 0x00, 0x80, 0x00, 0xFF, 0x00, 0x80, 0x40, 0x00, 0x40, 0x00, 0x10, 0x00,
+    0x00, 0x09, 0x01, 0xC0, 0xB7, 0x00, 0x00, 0x00, 0x20, 0x00, 0x0C, 0x01, 0x40, 0x80, 0x00, 0x00,
+    0x01, 0x02, 0x01, 0x13, 0x01, 0x80, 0x54, 0x00, 0x40, 0x80, 0x00, 0x00, 0x00, 0x25, 0x01, 0x40,
+    0x20, 0x00, 0x00, 0x00, 0x28, 0x01, 0x80, 0xD7, 0x00, 0x40, 0x00, 0x00, 0x08, 0x00, 0x36, 0x01,
+    0x80, 0xC1, 0x00, 0x40, 0x00, 0x00, 0x08, 0x00, 0x40, 0x01, 0x40, 0x00, 0x20, 0x00, 0x00, 0x43,
+    0x01, 0x40, 0x00, 0x00, 0x04, 0x00, 0x4A, 0x01, 0x40, 0x10, 0x20, 0x00, 0x00, 0x51, 0x01, 0x39,
+    0x01, 0x40, 0x00, 0x40, 0x00, 0x00, 0x58, 0x01,
+};
+
+static const uint8_t PROGMEM expansion_text[] = {
+    0x0C, 0x09, 0x2C, 0x8C, 0x2C, 0x15, 0x08, 0x10, 0x08, 0x10, 0x05, 0x08, 0x15, 0x2C, 0x06, 0x12,
+    0x15, 0x15, 0x08, 0x06, 0x17, 0x0F, 0x1C, 0x00, 0x04, 0x16, 0x2C, 0x16, 0x12, 0x12, 0x11, 0x2C,
+    0x04, 0x16, 0x2C, 0x13, 0x12, 0x16, 0x16, 0x0C, 0x05, 0x0F, 0x08, 0x00, 0x09, 0x12, 0x15, 0x2C,
+    0x1A, 0x0B, 0x04, 0x17, 0x2C, 0x0C, 0x17, 0x34, 0x16, 0x2C, 0x1A, 0x12, 0x15, 0x17, 0x0B, 0x00,
+    0x17, 0x0B, 0x04, 0x11, 0x0E, 0x2C, 0x1C, 0x12, 0x18, 0x2C, 0x19, 0x08, 0x15, 0x1C, 0x2C, 0x10,
+    0x18, 0x06, 0x0B, 0x00, 0x1A, 0x12, 0x15, 0x0E, 0x0C, 0x11, 0x0A, 0x2C, 0x09, 0x15, 0x12, 0x10,
+    0x2C, 0x0B, 0x12, 0x10, 0x08, 0x00, 0x04, 0x16, 0x2C, 0x09, 0x04, 0x15, 0x2C, 0x04, 0x16, 0x2C,
+    0x8C, 0x2C, 0x0E, 0x11, 0x12, 0x1A, 0x00, 0x0F, 0x12, 0x12, 0x0E, 0x16, 0x2C, 0x0A, 0x12, 0x12,
+    0x07, 0x2C, 0x17, 0x12, 0x2C, 0x10, 0x08, 0x00, 0x0C, 0x11, 0x2C, 0x10, 0x1C, 0x2C, 0x12, 0x13,
+    0x0C, 0x11, 0x0C, 0x12, 0x11, 0x00, 0x0F, 0x08, 0x17, 0x2C, 0x10, 0x08, 0x2C, 0x0E, 0x11, 0x12,
+    0x1A, 0x00, 0x05, 0x1C, 0x2C, 0x17, 0x0B, 0x08, 0x2C, 0x1A, 0x04, 0x1C, 0x00, 0x12, 0x11, 0x2C,
+    0x10, 0x1C, 0x2C, 0x1A, 0x04, 0x1C, 0x00, 0x17, 0x0B, 0x04, 0x11, 0x0E, 0x2C, 0x1C, 0x12, 0x18,
+    0x00, 0x07, 0x12, 0x08, 0x16, 0x11, 0x34, 0x17, 0x00, 0x13, 0x0F, 0x08, 0x04, 0x16, 0x08, 0x00,
+    0x17, 0x0B, 0x04, 0x11, 0x0E, 0x16, 0x00, 0x07, 0x12, 0x11, 0x34, 0x17, 0x00, 0x0C, 0x16, 0x11,
+    0x34, 0x17, 0x00, 0x8C, 0x34, 0x19, 0x08, 0x00, 0x8C, 0x34, 0x10, 0x00,
+};
+// clang-format on
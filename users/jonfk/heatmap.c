@@ -0,0 +1,159 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "heatmap.h"
+#include "hid_bytes.h"
+#include "raw_hid.h"
+
+#define HEATMAP_VERSION 1
+// Average of the gaps between presses, weight 1/8 for each new one.
+#define RATE_SHIFT 3
+#define GAP_UNIT_SHIFT 4
+
+_Static_assert(sizeof(heatmap_t) <= HEATMAP_DATA_SIZE, "HEATMAP_DATA_SIZE too small for the heatmap");
+_Static_assert(HEATMAP_MOD_TAPS < HEATMAP_NO_KEY && MATRIX_COLS <= 16, "mod-tap positions do not fit a byte");
+_Static_assert(HEATMAP_RATE_GAP_MS < (UINT16_MAX >> GAP_UNIT_SHIFT), "HEATMAP_RATE_GAP_MS does not fit the average");
+
+static heatmap_t heatmap;
+static uint8_t   slot_of[HEATMAP_KEYS]; // mod-tap slot of each key, HEATMAP_NO_KEY when none
+static uint8_t   last_mod_tap = HEATMAP_NO_KEY;
+static uint16_t  last_press;
+static uint16_t  gap_average; // 1/16 ms, 0 until two presses in a row
+static uint32_t  press_count;
+static bool      dirty;
+static uint32_t  last_checkpoint;
+static uint16_t  checkpoint_offset = sizeof(heatmap_t); // past the end when no checkpoint is running
+
+static void clear(void) {
+    memset(&heatmap, 0, sizeof(heatmap));
+    heatmap.version  = HEATMAP_VERSION;
+    heatmap.layers   = HEATMAP_LAYERS;
+    heatmap.mod_taps = HEATMAP_MOD_TAPS;
+    memset(heatmap.mod_tap_keys, HEATMAP_NO_KEY, sizeof(heatmap.mod_tap_keys));
+    memset(slot_of, HEATMAP_NO_KEY, sizeof(slot_of));
+    last_mod_tap = HEATMAP_NO_KEY;
+    gap_average  = 0;
+    press_count  = 0;
+}
+
+void heatmap_init(void) {
+    eeconfig_read_user_datablock(&heatmap, HEATMAP_DATA_OFFSET, sizeof(heatmap));
+    if (heatmap.version != HEATMAP_VERSION || heatmap.layers != HEATMAP_LAYERS || heatmap.mod_taps != HEATMAP_MOD_TAPS) {
+        clear();
+        return;
+    }
+    memset(slot_of, HEATMAP_NO_KEY, sizeof(slot_of));
+    for (uint8_t slot = 0; slot < HEATMAP_MOD_TAPS; slot++) {
+        uint8_t key = heatmap.mod_tap_keys[slot];
+        if (key != HEATMAP_NO_KEY) {
+            slot_of[(key >> 4) * MATRIX_COLS + (key & 0x0F)] = slot;
+        }
+    }
+}
+
+static uint8_t mod_tap_slot(keypos_t key, uint8_t index) {
+    if (slot_of[index] != HEATMAP_NO_KEY) {
+        return slot_of[index];
+    }
+    // Slots are handed out in order and never freed, so the first free one is the next.
+    for (uint8_t slot = 0; slot < HEATMAP_MOD_TAPS; slot++) {
+        if (heatmap.mod_tap_keys[slot] == HEATMAP_NO_KEY) {
+            heatmap.mod_tap_keys[slot] = key.row << 4 | key.col;
+            slot_of[index]             = slot;
+            return slot;
+        }
+    }
+    return HEATMAP_NO_KEY;
+}
+
+void heatmap_record(uint16_t keycode, keyrecord_t *record) {
+    if (record->event.type != KEY_EVENT || !record->event.pressed) {
+        return;
+    }
+    keypos_t key   = record->event.key;
+    uint8_t  index = key.row * MATRIX_COLS + key.col;
+    uint8_t  layer = layer_switch_get_layer(key);
+    uint16_t gap   = TIMER_DIFF_16(record->event.time, last_press);
+
+    if (layer < HEATMAP_LAYERS && heatmap.presses[layer][index] < UINT16_MAX) {
+        heatmap.presses[layer][index]++;
+    }
+    if (last_mod_tap != HEATMAP_NO_KEY && gap <= HEATMAP_BIGRAM_TERM && heatmap.bigrams[last_mod_tap][index] < UINT8_MAX) {
+        heatmap.bigrams[last_mod_tap][index]++;
+    }
+    // The keymap says whether this is a mod-tap; the keycode may already be rewritten to its tap.
+    last_mod_tap = IS_QK_MOD_TAP(keycode_at_keymap_location(layer, key.row, key.col)) ? mod_tap_slot(key, index) : HEATMAP_NO_KEY;
+
+    if (press_count && gap <= HEATMAP_RATE_GAP_MS) {
+        int32_t sample = (int32_t)gap << GAP_UNIT_SHIFT;
+        gap_average    = gap_average ? gap_average + ((sample - gap_average) >> RATE_SHIFT) : sample;
+    }
+    last_press = record->event.time;
+    press_count++;
+    dirty = true;
+}
+
+void heatmap_task(void) {
+    if (checkpoint_offset < sizeof(heatmap)) {
+        uint16_t n = MIN(HEATMAP_CHECKPOINT_CHUNK, sizeof(heatmap) - checkpoint_offset);
+        eeconfig_update_user_datablock((const uint8_t *)&heatmap + checkpoint_offset, HEATMAP_DATA_OFFSET + checkpoint_offset, n);
+        checkpoint_offset += n;
+        return;
+    }
+    if (dirty && timer_elapsed32(last_checkpoint) >= HEATMAP_CHECKPOINT_MS) {
+        // Presses during the checkpoint land in it or in the next one.
+        dirty             = false;
+        checkpoint_offset = 0;
+        last_checkpoint   = timer_read32();
+    }
+}
+
+bool heatmap_raw_hid_receive(uint8_t *data, uint8_t length) {
+    if (length < 4 || data[0] != HEATMAP_HID_ID) {
+        return false;
+    }
+    uint8_t  command = data[1];
+    uint16_t offset  = data[2] | data[3] << 8;
+    memset(data + 1, 0, length - 1);
+
+    switch (command) {
+        case HEATMAP_HID_INFO:
+            data[1] = HEATMAP_VERSION;
+            data[2] = MATRIX_ROWS;
+            data[3] = MATRIX_COLS;
+            data[4] = HEATMAP_LAYERS;
+            data[5] = HEATMAP_MOD_TAPS;
+            put_u16(&data[6], sizeof(heatmap));
+            put_u16(&data[8], gap_average);
+            put_u32(&data[10], press_count);
+            break;
+        case HEATMAP_HID_READ:
+            if (offset < sizeof(heatmap)) {
+                uint8_t n = MIN(length - 2, sizeof(heatmap) - offset);
+                data[1]   = n;
+                memcpy(&data[2], (const uint8_t *)&heatmap + offset, n);
+            }
+            break;
+        case HEATMAP_HID_CLEAR:
+            clear();
+            dirty = true;
+            break;
+    }
+    raw_hid_send(data, length);
+    return true;
+}
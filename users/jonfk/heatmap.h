@@ -0,0 +1,64 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Key usage heatmap and typing rate, read back over raw HID.
+ *
+ * Every key press counts once against its matrix position on the layer it
+ * came from, for the first HEATMAP_LAYERS layers. Presses that follow a
+ * mod-tap within HEATMAP_BIGRAM_TERM count against that mod-tap and the key
+ * pressed, for up to HEATMAP_MOD_TAPS mod-tap positions, taken as they are
+ * first used. Counters saturate instead of wrapping. The typing rate is an
+ * exponential moving average of the gap between presses, in 1/16 ms, that
+ * leaves out pauses longer than HEATMAP_RATE_GAP_MS.
+ *
+ * All of it is O(1) per press in a fixed heatmap_t, which is also the
+ * checkpoint written to the user EEPROM datablock after
+ * HEATMAP_CHECKPOINT_MS, HEATMAP_CHECKPOINT_CHUNK bytes per housekeeping
+ * pass, and the dump util/heatmap.py reads with HEATMAP_HID_ID requests.
+ */
+
+/* Raw HID packets starting with this byte belong to the heatmap. */
+#define HEATMAP_HID_ID 0x48
+
+enum heatmap_hid_command {
+    HEATMAP_HID_INFO  = 0, // reply: version, rows, cols, layers, mod-taps (u8), table size (u16), gap average (u16), presses (u32)
+    HEATMAP_HID_READ  = 1, // request: offset (u16); reply: byte count (u8), then up to 30 bytes of the table
+    HEATMAP_HID_CLEAR = 2,
+};
+
+#define HEATMAP_KEYS (MATRIX_ROWS * MATRIX_COLS)
+#define HEATMAP_NO_KEY 0xFF
+
+/* The table as stored and sent to the host, little-endian. */
+typedef struct {
+    uint8_t  version;
+    uint8_t  layers;
+    uint8_t  mod_taps;
+    uint8_t  reserved;
+    uint16_t presses[HEATMAP_LAYERS][HEATMAP_KEYS];
+    uint8_t  mod_tap_keys[HEATMAP_MOD_TAPS]; // row << 4 | col, HEATMAP_NO_KEY when unused
+    uint8_t  bigrams[HEATMAP_MOD_TAPS][HEATMAP_KEYS];
+} heatmap_t;
+
+void heatmap_init(void);
+void heatmap_task(void);
+void heatmap_record(uint16_t keycode, keyrecord_t *record);
+bool heatmap_raw_hid_receive(uint8_t *data, uint8_t length);
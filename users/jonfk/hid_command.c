@@ -0,0 +1,160 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "jonfk.h"
+#include "raw_hid.h"
+
+#ifdef MACRO_QUEUE_ENABLE
+_Static_assert(HID_COMMAND_MACRO_KEYS <= MACRO_QUEUE_SIZE, "A macro must fit in the macro queue");
+#endif
+
+typedef struct {
+    uint8_t  count;
+    uint16_t keys[HID_COMMAND_MACRO_KEYS];
+} macro_t;
+
+static macro_t macros[USER_MACRO_COUNT];
+
+bool hid_command_play_macro(uint8_t slot) {
+    const macro_t *macro = &macros[slot];
+    for (uint8_t i = 0; i < macro->count; i++) {
+        macro_queue_tap16(macro->keys[i]);
+    }
+    return macro->count > 0;
+}
+
+static uint8_t set_layer(const hid_command_layer_t *request) {
+    if (request->layer >= keymap_layer_count()) {
+        return HID_COMMAND_INVALID;
+    }
+    if (request->persist) {
+#ifdef SETTINGS_CACHE_ENABLE
+        settings_set_default_layer(request->layer);
+#else
+        // Not through set_single_persistent_default_layer: its song table may hold fewer layers.
+        default_layer_set((layer_state_t)1 << request->layer);
+        eeconfig_update_default_layer((layer_state_t)1 << request->layer);
+#endif
+    } else {
+        default_layer_set((layer_state_t)1 << request->layer);
+    }
+    TLOG(DEFAULT_LAYER, request->layer);
+    return HID_COMMAND_OK;
+}
+
+static uint8_t get_macro(hid_command_macro_t *reply) {
+    uint8_t slot = reply->slot;
+    if (slot >= USER_MACRO_COUNT) {
+        return HID_COMMAND_INVALID;
+    }
+    reply->count = macros[slot].count;
+    memcpy(reply->keys, macros[slot].keys, sizeof(reply->keys));
+    return HID_COMMAND_OK;
+}
+
+static uint8_t set_macro(const hid_command_macro_t *request) {
+    if (request->slot >= USER_MACRO_COUNT || request->count > HID_COMMAND_MACRO_KEYS) {
+        return HID_COMMAND_INVALID;
+    }
+    macro_t *macro = &macros[request->slot];
+    macro->count   = request->count;
+    memcpy(macro->keys, request->keys, request->count * sizeof(uint16_t));
+    return HID_COMMAND_OK;
+}
+
+static uint8_t get_key(hid_command_key_t *reply) {
+    if (reply->layer >= keymap_layer_count() || reply->row >= MATRIX_ROWS || reply->col >= MATRIX_COLS) {
+        return HID_COMMAND_INVALID;
+    }
+    reply->keycode = keycode_at_keymap_location(reply->layer, reply->row, reply->col);
+    return HID_COMMAND_OK;
+}
+
+static void get_info(hid_command_info_t *reply) {
+    *reply = (hid_command_info_t){
+        .version     = HID_COMMAND_VERSION,
+        .layers      = keymap_layer_count(),
+        .macro_slots = USER_MACRO_COUNT,
+        .macro_keys  = HID_COMMAND_MACRO_KEYS,
+#ifdef KEYMAP_STORE_ENABLE
+        .remappable_layers = MIN(keymap_layer_count(), KEYMAP_STORE_LAYERS),
+        .keymap_bytes      = keymap_store_encoded_size(),
+        .keymap_capacity   = KEYMAP_STORE_DATA_SIZE,
+#endif
+    };
+}
+
+static void get_state(hid_command_state_t *reply) {
+    reply->layer_state         = layer_state;
+    reply->default_layer_state = default_layer_state;
+    reply->keymap_config       = keymap_config.raw;
+    reply->mods                = get_mods();
+    reply->oneshot_mods        = get_oneshot_mods();
+    for (uint8_t i = 0; i < USER_MACRO_COUNT; i++) {
+        reply->macro_lengths[i] = macros[i].count;
+    }
+}
+
+bool hid_command_raw_hid_receive(uint8_t *data, uint8_t length) {
+    if (length < HID_COMMAND_PACKET_SIZE || data[0] != HID_COMMAND_ID) {
+        return false;
+    }
+    hid_command_packet_t *packet = (hid_command_packet_t *)data;
+    uint8_t               status = HID_COMMAND_OK;
+
+    // Requests are read before their reply is written over them, so set
+    // commands reply with the body they were sent.
+    switch (packet->command) {
+        case HID_COMMAND_INFO:
+            memset(packet->body, 0, sizeof(packet->body));
+            get_info(&packet->info);
+            break;
+        case HID_COMMAND_STATE:
+            memset(packet->body, 0, sizeof(packet->body));
+            get_state(&packet->state);
+            break;
+        case HID_COMMAND_SET_LAYER:
+            status = set_layer(&packet->layer);
+            break;
+        case HID_COMMAND_GET_MACRO:
+            status = get_macro(&packet->macro);
+            break;
+        case HID_COMMAND_SET_MACRO:
+            status = set_macro(&packet->macro);
+            break;
+        case HID_COMMAND_GET_KEY:
+            status = get_key(&packet->key);
+            break;
+#ifdef KEYMAP_STORE_ENABLE
+        // Writes through to EEPROM: the one command that is not bounded by
+        // the packet, at most KEYMAP_STORE_DATA_SIZE bytes compared.
+        case HID_COMMAND_SET_KEY:
+            status = keymap_store_set(packet->key.layer, packet->key.row, packet->key.col, packet->key.keycode) ? HID_COMMAND_OK : HID_COMMAND_INVALID;
+            break;
+        case HID_COMMAND_RESET_KEYMAP:
+            keymap_store_reset();
+            break;
+#endif
+        default:
+            status = HID_COMMAND_UNKNOWN;
+            break;
+    }
+    packet->status = status;
+    raw_hid_send(data, length);
+    return true;
+}
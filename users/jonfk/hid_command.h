@@ -0,0 +1,118 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Runtime control over raw HID: query the keyboard state, switch the default
+ * layer, replace the MA_* macros and, with KEYMAP_STORE_ENABLE, remap keys
+ * without reflashing.
+ *
+ * Every packet has the fixed layout of hid_command_packet_t, and requests and
+ * replies share it: the handler reads the request fields in place and
+ * overwrites the same buffer with the reply, with no parsing pass or copy.
+ * Multi-byte fields are little-endian, as the MCU is. Each command is a
+ * bounded amount of work, at most one macro's worth of keycodes copied or one
+ * keymap written through to EEPROM, and runs from raw_hid_receive() on the
+ * main loop, between two matrix scans.
+ *
+ * A macro is up to HID_COMMAND_MACRO_KEYS 16-bit keycodes, such as
+ * LCTL(KC_C), tapped one after the other through the macro queue. Macros set
+ * from the host live in RAM and replace the built-in ones from
+ * user_keycodes.c until they are cleared or the keyboard restarts. A whole
+ * macro fits in one packet, so a key never plays half of a new one.
+ */
+
+/* Raw HID packets starting with this byte are commands. */
+#define HID_COMMAND_ID 0x43
+#define HID_COMMAND_VERSION 2
+#define HID_COMMAND_PACKET_SIZE 32
+
+enum hid_command {
+    HID_COMMAND_INFO         = 0, // reply: hid_command_info_t
+    HID_COMMAND_STATE        = 1, // reply: hid_command_state_t
+    HID_COMMAND_SET_LAYER    = 2, // request: hid_command_layer_t
+    HID_COMMAND_GET_MACRO    = 3, // request: slot; reply: hid_command_macro_t, count 0 while the built-in macro plays
+    HID_COMMAND_SET_MACRO    = 4, // request: hid_command_macro_t, count 0 restores the built-in macro
+    HID_COMMAND_GET_KEY      = 5, // request: layer, row, col; reply: hid_command_key_t
+    HID_COMMAND_SET_KEY      = 6, // request: hid_command_key_t, KEYMAP_STORE_ENABLE only
+    HID_COMMAND_RESET_KEYMAP = 7, // back to the compiled keymap, KEYMAP_STORE_ENABLE only
+};
+
+enum hid_command_status {
+    HID_COMMAND_OK = 0,
+    HID_COMMAND_UNKNOWN, // no such command, the host may be newer than the firmware
+    HID_COMMAND_INVALID, // out of range argument or no room left, nothing was changed
+};
+
+typedef struct __attribute__((packed)) {
+    uint8_t  version;
+    uint8_t  layers;
+    uint8_t  macro_slots;
+    uint8_t  macro_keys;
+    uint8_t  remappable_layers; // 0 without KEYMAP_STORE_ENABLE
+    uint16_t keymap_bytes;      // stored size of the keymap
+    uint16_t keymap_capacity;
+} hid_command_info_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t layer_state;
+    uint32_t default_layer_state;
+    uint16_t keymap_config;
+    uint8_t  mods;
+    uint8_t  oneshot_mods;
+    uint8_t  macro_lengths[USER_MACRO_COUNT]; // 0 for built-in macros
+} hid_command_state_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t layer;
+    uint8_t persist; // also store it in EEPROM, as the DVORAK/QWERTY keys do
+} hid_command_layer_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  slot; // keycode - MA_WI_COPY
+    uint8_t  count;
+    uint16_t keys[HID_COMMAND_MACRO_KEYS];
+} hid_command_macro_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  layer;
+    uint8_t  row;
+    uint8_t  col;
+    uint16_t keycode;
+} hid_command_key_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t id;
+    uint8_t command;
+    uint8_t status; // in replies only
+    union {
+        hid_command_info_t  info;
+        hid_command_state_t state;
+        hid_command_layer_t layer;
+        hid_command_macro_t macro;
+        hid_command_key_t   key;
+        uint8_t             body[HID_COMMAND_PACKET_SIZE - 3];
+    };
+} hid_command_packet_t;
+
+_Static_assert(sizeof(hid_command_packet_t) == HID_COMMAND_PACKET_SIZE, "Command bodies must fit in one raw HID packet");
+
+/* Queues the host's macro for the slot; false when the built-in one applies. */
+bool hid_command_play_macro(uint8_t slot);
+bool hid_command_raw_hid_receive(uint8_t *data, uint8_t length);
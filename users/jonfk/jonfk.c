@@ -0,0 +1,218 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jonfk.h"
+
+__attribute__((weak)) void keyboard_post_init_keymap(void) {}
+
+void keyboard_post_init_user(void) {
+#ifdef TLOG_ENABLE
+    tlog_init();
+#endif
+#ifdef TIMER_WHEEL_ENABLE
+    timer_wheel_init();
+#endif
+#ifdef SETTINGS_CACHE_ENABLE
+    settings_init();
+#endif
+#ifdef KEYMAP_STORE_ENABLE
+    keymap_store_init();
+#endif
+#ifdef LATENCY_TRACE_ENABLE
+    latency_init();
+#endif
+#ifdef TAPPING_TERM_TUNER_ENABLE
+    tapping_term_tuner_init();
+#endif
+#ifdef SPLIT_SYNC_ENABLE
+    split_sync_init();
+#endif
+#ifdef LAYER_LIGHTS_ENABLE
+    layer_lights_init();
+#endif
+#ifdef HEATMAP_ENABLE
+    heatmap_init();
+#endif
+    keyboard_post_init_keymap();
+}
+
+__attribute__((weak)) void housekeeping_task_keymap(void) {}
+
+void housekeeping_task_user(void) {
+#ifdef TIMER_WHEEL_ENABLE
+    timer_wheel_task();
+#endif
+#ifdef LATENCY_TRACE_ENABLE
+    latency_task();
+#endif
+#ifdef TAPPING_TERM_TUNER_ENABLE
+    tapping_term_tuner_task();
+#endif
+#ifdef TEXT_EXPANSION_ENABLE
+    text_expansion_task();
+#endif
+#ifdef MACRO_QUEUE_ENABLE
+    macro_queue_task();
+#endif
+#ifdef SPLIT_SYNC_ENABLE
+    split_sync_task();
+#endif
+#ifdef WAVETABLE_AUDIO_ENABLE
+    wavetable_task();
+#endif
+#ifdef HEATMAP_ENABLE
+    heatmap_task();
+#endif
+#ifdef TLOG_ENABLE
+    tlog_task();
+#endif
+    housekeeping_task_keymap();
+#ifdef ADAPTIVE_SCAN_ENABLE
+    // Last, as it may sleep until the next scan.
+    adaptive_scan_task();
+#endif
+}
+
+#ifdef SETTINGS_CACHE_ENABLE
+__attribute__((weak)) bool shutdown_keymap(bool jump_to_bootloader) {
+    return true;
+}
+
+bool shutdown_user(bool jump_to_bootloader) {
+    settings_flush();
+    return shutdown_keymap(jump_to_bootloader);
+}
+#endif
+
+__attribute__((weak)) bool pre_process_record_keymap(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+#ifdef LATENCY_TRACE_ENABLE
+    latency_mark(LATENCY_KEY, keycode, record);
+#endif
+#ifdef TAPPING_TERM_TUNER_ENABLE
+    // Sees mod-taps before the predictive tap-hold rewrites them.
+    pre_process_tapping_term_tuner(keycode, record);
+#endif
+#ifdef PREDICTIVE_TAP_HOLD_ENABLE
+    keycode = pre_process_predictive_tap_hold(keycode, record);
+#endif
+    return pre_process_record_keymap(keycode, record);
+}
+
+__attribute__((weak)) bool process_record_keymap(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+#ifdef LATENCY_TRACE_ENABLE
+    latency_mark(LATENCY_RESOLVED, keycode, record);
+#endif
+#ifdef HEATMAP_ENABLE
+    heatmap_record(keycode, record);
+#endif
+#ifdef TEXT_EXPANSION_ENABLE
+    if (!process_text_expansion(keycode, record)) {
+        return false;
+    }
+#endif
+    if (!process_user_keycode(keycode, record)) {
+        return false;
+    }
+    return process_record_keymap(keycode, record);
+}
+
+__attribute__((weak)) void post_process_record_keymap(uint16_t keycode, keyrecord_t *record) {}
+
+void post_process_record_user(uint16_t keycode, keyrecord_t *record) {
+#ifdef LATENCY_TRACE_ENABLE
+    latency_mark(LATENCY_HANDLED, keycode, record);
+#endif
+#ifdef TAPPING_TERM_TUNER_ENABLE
+    post_process_tapping_term_tuner(keycode, record);
+#endif
+    post_process_record_keymap(keycode, record);
+}
+
+#ifdef POINTING_DEVICE_ENABLE
+__attribute__((weak)) report_mouse_t pointing_device_task_keymap(report_mouse_t mouse_report) {
+    return mouse_report;
+}
+
+report_mouse_t pointing_device_task_user(report_mouse_t mouse_report) {
+#    ifdef ENCODER_SCROLL_ENABLE
+    mouse_report = encoder_scroll_task(mouse_report);
+#    endif
+    return pointing_device_task_keymap(mouse_report);
+}
+#endif
+
+#ifdef RGB_MATRIX_ENABLE
+__attribute__((weak)) bool rgb_matrix_indicators_advanced_keymap(uint8_t led_min, uint8_t led_max) {
+    return true;
+}
+
+bool rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max) {
+#    ifdef LAYER_LIGHTS_ENABLE
+    layer_lights_render(led_min, led_max);
+#    endif
+    return rgb_matrix_indicators_advanced_keymap(led_min, led_max);
+}
+#endif
+
+#ifdef RAW_ENABLE
+__attribute__((weak)) void raw_hid_receive_keymap(uint8_t *data, uint8_t length) {}
+
+void raw_hid_receive(uint8_t *data, uint8_t length) {
+#    ifdef LATENCY_TRACE_ENABLE
+    if (latency_raw_hid_receive(data, length)) {
+        return;
+    }
+#    endif
+#    ifdef WAVETABLE_AUDIO_ENABLE
+    if (wavetable_raw_hid_receive(data, length)) {
+        return;
+    }
+#    endif
+#    ifdef HEATMAP_ENABLE
+    if (heatmap_raw_hid_receive(data, length)) {
+        return;
+    }
+#    endif
+#    ifdef HID_COMMAND_ENABLE
+    if (hid_command_raw_hid_receive(data, length)) {
+        return;
+    }
+#    endif
+    raw_hid_receive_keymap(data, length);
+}
+#endif
+
+#ifdef COMBO_ENABLE
+void process_combo_event(uint16_t combo_index, bool pressed) {
+    switch (combo_index) {
+#    ifdef CAPS_WORD_ENABLE
+        case CAPS_COMBO:
+            if (pressed) {
+                caps_word_on();
+            }
+            break;
+#    endif
+    }
+}
+#endif
@@ -0,0 +1,164 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/* Base layers shared by the keymaps; keymap layers start at USER_SAFE_LAYER. */
+enum userspace_layers {
+    _DVORAK,
+    _QWERTY,
+    USER_SAFE_LAYER,
+};
+
+/*
+ * Keycodes handled in userspace, dispatched through the table in
+ * user_keycodes.c; keymaps start their own at USER_SAFE_RANGE.
+ */
+enum userspace_keycodes {
+    SCRL_UP = SAFE_RANGE,
+    SCRL_DN,
+    NOTE_UP,
+    NOTE_DN,
+    NOTE_TG,
+    QWERTY,
+    DVORAK,
+    MA_WI_COPY,
+    MA_WI_CUT,
+    MA_WI_PSTE,
+    USER_SAFE_RANGE,
+};
+
+/* Macro keycodes, numbered from 0 as macro slots */
+#define USER_MACRO_COUNT (MA_WI_PSTE - MA_WI_COPY + 1)
+
+// Dvorak: Left-hand bottom row mods
+#define BR_SCLN LGUI_T(KC_SCLN)
+#define BR_Q LALT_T(KC_Q)
+#define BR_J LSFT_T(KC_J)
+#define BR_K LCTL_T(KC_K)
+
+// Dvorak: Right-hand bottom row mods
+#define BR_M RCTL_T(KC_M)
+#define BR_W RSFT_T(KC_W)
+#define BR_V LALT_T(KC_V)
+#define BR_Z RGUI_T(KC_Z)
+
+/*
+ * Mod-taps on 16-bit keycodes. The core only keeps a basic tap keycode, so
+ * MT16 stores a slot in the unused basic range from MT16_BASE and the slot is
+ * looked up in mod_tap16_keycodes (user_keycodes.c) once the key is a tap.
+ * See: https://docs.qmk.fm/mod_tap#caveats
+ */
+enum mod_tap16_slots {
+    MT16_TILD,
+    MT16_DQUO,
+    MOD_TAP16_COUNT,
+};
+
+#define MT16_BASE 0xE8
+#define MT16(mod, slot) MT(mod, MT16_BASE + (slot))
+
+_Static_assert(MT16_BASE + MOD_TAP16_COUNT <= 0x100, "Too many 16-bit mod-tap slots");
+
+/* Tap keycode of a mod-tap, 16-bit for MT16 slots */
+uint16_t mod_tap_get_tap_keycode(uint16_t keycode);
+
+// LOWER/SYM: Left-hand bottom row mods
+#define BR_TILD MT16(MOD_LGUI, MT16_TILD)
+//#define BR_ASTR LALT_T(KC_KP_ASTERISK) // Defined on base layer, pass through
+#define BR_DQUO MT16(MOD_LSFT, MT16_DQUO)
+#define BR_QUOT LCTL_T(KC_QUOT)
+
+// LOWER/SYM: Right-hand bottom row mods
+// First finger not necessary, pass through
+#define BR_LBRC RSFT_T(KC_LBRC)
+#define BR_RBRC RALT_T(KC_RBRC)
+// last finger not necessary, pass through
+
+/* Combos, defined for both keymaps in combos.h */
+enum combo_events {
+    ESC_COMBO,
+    CAPS_COMBO,
+    COMBO_LENGTH
+};
+
+#include "tlog.h"
+#ifdef PREDICTIVE_TAP_HOLD_ENABLE
+#    include "tap_hold.h"
+#endif
+#ifdef TAPPING_TERM_TUNER_ENABLE
+#    include "tapping_term.h"
+#endif
+#ifdef LATENCY_TRACE_ENABLE
+#    include "latency.h"
+#endif
+#ifdef SETTINGS_CACHE_ENABLE
+#    include "settings.h"
+#else
+#    define settings_set_default_layer(layer) set_single_persistent_default_layer(layer)
+#endif
+#ifdef ENCODER_SCROLL_ENABLE
+#    include "encoder_scroll.h"
+#endif
+#ifdef ENCODER_NOTES_ENABLE
+#    include "encoder_notes.h"
+#endif
+#ifdef WAVETABLE_AUDIO_ENABLE
+#    include "wavetable.h"
+#endif
+#ifdef HEATMAP_ENABLE
+#    include "heatmap.h"
+#endif
+#ifdef SPLIT_SYNC_ENABLE
+#    include "split_sync.h"
+#endif
+#ifdef LAYER_LIGHTS_ENABLE
+#    include "layer_lights.h"
+#endif
+#ifdef ADAPTIVE_SCAN_ENABLE
+#    include "adaptive_scan.h"
+#endif
+#ifdef TIMER_WHEEL_ENABLE
+#    include "timer_wheel.h"
+#endif
+#ifdef MACRO_QUEUE_ENABLE
+#    include "macro_queue.h"
+#else
+#    define macro_queue_tap16(keycode) (tap_code16(keycode), true)
+#endif
+#ifdef TEXT_EXPANSION_ENABLE
+#    include "text_expansion.h"
+#endif
+#ifdef KEYMAP_STORE_ENABLE
+#    include "keymap_store.h"
+#endif
+#ifdef HID_COMMAND_ENABLE
+#    include "hid_command.h"
+#endif
+
+bool process_user_keycode(uint16_t keycode, keyrecord_t *record);
+
+void keyboard_post_init_keymap(void);
+void housekeeping_task_keymap(void);
+bool shutdown_keymap(bool jump_to_bootloader);
+bool pre_process_record_keymap(uint16_t keycode, keyrecord_t *record);
+bool process_record_keymap(uint16_t keycode, keyrecord_t *record);
+void post_process_record_keymap(uint16_t keycode, keyrecord_t *record);
+void raw_hid_receive_keymap(uint8_t *data, uint8_t length);
+report_mouse_t pointing_device_task_keymap(report_mouse_t mouse_report);
+bool rgb_matrix_indicators_advanced_keymap(uint8_t led_min, uint8_t led_max);
@@ -0,0 +1,264 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keymap_store.h"
+#ifdef LAYER_LIGHTS_ENABLE
+#    include "layer_lights.h"
+#endif
+
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#    error "KEYMAP_STORE_ENABLE replaces DYNAMIC_KEYMAP_ENABLE, turn one of them off"
+#endif
+
+#define KEYS_PER_LAYER (MATRIX_ROWS * MATRIX_COLS)
+#define RUN_FLAG 0x80
+#define RUN_TRNS 0x40
+#define RUN_MAX 64
+#define LITERAL_MAX 0x7FFF
+#define CHUNK 32
+
+static uint16_t keymap[KEYMAP_STORE_LAYERS][MATRIX_ROWS][MATRIX_COLS];
+static uint8_t  layers;
+
+/*
+ * CRC-16/CCITT, bit by bit; it runs at boot and on a remap only. Fletcher-16
+ * would be cheaper but cannot tell 0x00 from 0xFF, which are both common
+ * bytes here: a literal's high byte and a full run of KC_TRNS.
+ */
+typedef uint16_t checksum_t;
+
+#define CHECKSUM_INIT 0xFFFF
+
+static void checksum_add(checksum_t *c, uint8_t byte) {
+    *c ^= (uint16_t)byte << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        *c = *c & 0x8000 ? *c << 1 ^ 0x1021 : *c << 1;
+    }
+}
+
+static uint16_t checksum_value(const checksum_t *c) {
+    return *c;
+}
+
+/* Over the compiled layers the mirror covers */
+static uint16_t builtin_checksum(void) {
+    checksum_t checksum = CHECKSUM_INIT;
+    for (uint8_t layer = 0; layer < layers; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                uint16_t keycode = keycode_at_keymap_location_raw(layer, row, col);
+                checksum_add(&checksum, keycode & 0xFF);
+                checksum_add(&checksum, keycode >> 8);
+            }
+        }
+    }
+    return checksum_value(&checksum);
+}
+
+static void load_builtin(void) {
+    for (uint8_t layer = 0; layer < layers; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                keymap[layer][row][col] = keycode_at_keymap_location_raw(layer, row, col);
+            }
+        }
+    }
+}
+
+/*
+ * The encoding streams through a chunk buffer, so neither direction needs
+ * a RAM copy of the whole stored keymap. A writer with write unset only
+ * counts.
+ */
+
+typedef struct {
+    uint8_t    buffer[CHUNK];
+    uint8_t    fill;
+    uint16_t   length;
+    bool       write;
+    checksum_t checksum;
+} writer_t;
+
+static void put(writer_t *w, uint8_t byte) {
+    checksum_add(&w->checksum, byte);
+    if (w->write) {
+        w->buffer[w->fill++] = byte;
+        if (w->fill == CHUNK) {
+            eeconfig_update_user_datablock(w->buffer, KEYMAP_STORE_DATA_OFFSET + sizeof(keymap_store_header_t) + w->length + 1 - CHUNK, CHUNK);
+            w->fill = 0;
+        }
+    }
+    w->length++;
+}
+
+static void flush(writer_t *w) {
+    if (w->write && w->fill) {
+        eeconfig_update_user_datablock(w->buffer, KEYMAP_STORE_DATA_OFFSET + sizeof(keymap_store_header_t) + w->length - w->fill, w->fill);
+        w->fill = 0;
+    }
+}
+
+static void put_run(writer_t *w, uint16_t keycode, uint8_t run) {
+    if (run) {
+        put(w, RUN_FLAG | (keycode == KC_TRNS ? RUN_TRNS : 0) | (run - 1));
+    }
+}
+
+static void encode(writer_t *w) {
+    const uint16_t *keys = &keymap[0][0][0];
+    uint16_t        run_keycode = KC_NO;
+    uint8_t         run         = 0;
+
+    for (uint16_t i = 0; i < layers * KEYS_PER_LAYER; i++) {
+        uint16_t keycode = keys[i];
+        if (keycode == KC_TRNS || keycode == KC_NO) {
+            if (run && (keycode != run_keycode || run == RUN_MAX)) {
+                put_run(w, run_keycode, run);
+                run = 0;
+            }
+            run_keycode = keycode;
+            run++;
+            continue;
+        }
+        put_run(w, run_keycode, run);
+        run = 0;
+        put(w, keycode >> 8);
+        put(w, keycode & 0xFF);
+    }
+    put_run(w, run_keycode, run);
+    flush(w);
+}
+
+typedef struct {
+    uint8_t    buffer[CHUNK];
+    uint8_t    fill;
+    uint8_t    next;
+    uint16_t   offset; // next byte to read from the datablock
+    uint16_t   left;   // encoded bytes not consumed yet
+    checksum_t checksum;
+} reader_t;
+
+static bool get(reader_t *r, uint8_t *byte) {
+    if (!r->left) {
+        return false;
+    }
+    if (r->next == r->fill) {
+        r->fill = MIN(CHUNK, r->left);
+        r->next = 0;
+        eeconfig_read_user_datablock(r->buffer, KEYMAP_STORE_DATA_OFFSET + r->offset, r->fill);
+        r->offset += r->fill;
+    }
+    *byte = r->buffer[r->next++];
+    checksum_add(&r->checksum, *byte);
+    r->left--;
+    return true;
+}
+
+/* Decodes into the mirror; false, with the mirror half written, on any mismatch. */
+static bool decode(const keymap_store_header_t *header) {
+    reader_t  r    = {.offset = sizeof(keymap_store_header_t), .left = header->length, .checksum = CHECKSUM_INIT};
+    uint16_t *keys = &keymap[0][0][0];
+    uint16_t  i    = 0;
+    uint8_t   byte, low;
+
+    while (get(&r, &byte)) {
+        if (byte & RUN_FLAG) {
+            uint8_t  n       = (byte & (RUN_MAX - 1)) + 1;
+            uint16_t keycode = (byte & RUN_TRNS) ? KC_TRNS : KC_NO;
+            if (i + n > layers * KEYS_PER_LAYER) {
+                return false;
+            }
+            while (n--) {
+                keys[i++] = keycode;
+            }
+        } else {
+            if (i == layers * KEYS_PER_LAYER || !get(&r, &low)) {
+                return false;
+            }
+            keys[i++] = byte << 8 | low;
+        }
+    }
+    // A remap cut short leaves old and new bytes that may still decode.
+    return i == layers * KEYS_PER_LAYER && checksum_value(&r.checksum) == header->body_checksum;
+}
+
+static void write_header(const writer_t *w) {
+    keymap_store_header_t header = {KEYMAP_STORE_VERSION, layers, w->length, builtin_checksum(), checksum_value(&w->checksum)};
+    eeconfig_update_user_datablock(&header, KEYMAP_STORE_DATA_OFFSET, sizeof(header));
+}
+
+static void keymap_changed(void) {
+#ifdef LAYER_LIGHTS_ENABLE
+    layer_lights_keymap_changed();
+#endif
+}
+
+static void clear(void) {
+    keymap_store_header_t header = {0};
+    eeconfig_update_user_datablock(&header, KEYMAP_STORE_DATA_OFFSET, sizeof(header));
+    load_builtin();
+}
+
+void keymap_store_reset(void) {
+    clear();
+    keymap_changed();
+}
+
+void keymap_store_init(void) {
+    layers = MIN(keymap_layer_count(), KEYMAP_STORE_LAYERS);
+
+    keymap_store_header_t header;
+    eeconfig_read_user_datablock(&header, KEYMAP_STORE_DATA_OFFSET, sizeof(header));
+    bool stored = header.version == KEYMAP_STORE_VERSION && header.layers == layers && header.length <= KEYMAP_STORE_DATA_SIZE - sizeof(header) && header.checksum == builtin_checksum();
+    if (!stored || !decode(&header)) {
+        // Clears the header too, so a later remap cut short cannot bring back an older keymap.
+        clear();
+    }
+}
+
+uint16_t keymap_store_encoded_size(void) {
+    writer_t counter = {.write = false, .checksum = CHECKSUM_INIT};
+    encode(&counter);
+    return sizeof(keymap_store_header_t) + counter.length;
+}
+
+bool keymap_store_set(uint8_t layer, uint8_t row, uint8_t col, uint16_t keycode) {
+    if (layer >= layers || row >= MATRIX_ROWS || col >= MATRIX_COLS || keycode > LITERAL_MAX) {
+        return false;
+    }
+    uint16_t previous = keymap[layer][row][col];
+    if (keycode == previous) {
+        return true;
+    }
+    keymap[layer][row][col] = keycode;
+    if (keymap_store_encoded_size() > KEYMAP_STORE_DATA_SIZE) {
+        keymap[layer][row][col] = previous;
+        return false;
+    }
+
+    writer_t writer = {.write = true, .checksum = CHECKSUM_INIT};
+    encode(&writer);
+    write_header(&writer);
+    keymap_changed();
+    return true;
+}
+
+uint16_t keycode_at_keymap_location(uint8_t layer, uint8_t row, uint8_t col) {
+    if (layer < layers && row < MATRIX_ROWS && col < MATRIX_COLS) {
+        return keymap[layer][row][col];
+    }
+    return keycode_at_keymap_location_raw(layer, row, col);
+}
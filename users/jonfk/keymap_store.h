@@ -0,0 +1,65 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Remappable keymap, served from RAM.
+ *
+ * At boot the first KEYMAP_STORE_LAYERS layers are copied into a RAM mirror,
+ * from the user EEPROM datablock when a remapped keymap is stored there and
+ * from the compiled keymap otherwise. keycode_at_keymap_location() reads the
+ * mirror, so a key press costs an array read as with the compiled keymap and
+ * never touches EEPROM. A remap updates the mirror and is written through to
+ * EEPROM right away.
+ *
+ * The core still finds a key's layer by walking the active layers from the
+ * top, through action_for_key, for every press. That walk is not a hook, so
+ * a cache of each position's effective keycode would not shorten it; the
+ * mirror only makes each step of it an array read.
+ *
+ * The stored keymap is a keymap_store_header_t followed by the layers, row
+ * by row, in a run-length encoding:
+ *
+ *   1tnnnnnn   n + 1 copies of KC_TRNS (t = 1) or KC_NO (t = 0)
+ *   0hhhhhhh   a keycode below 0x8000, high 7 bits, then its low byte
+ *
+ * so the _______ and XXXXXXX regions of sparse layers, and the matrix
+ * positions no key sits on, cost a byte per 64 keys.
+ *
+ * The header records a checksum of the compiled keymap, so flashing a
+ * changed keymap.c drops remaps made against the old one, and a checksum of
+ * the encoded layers. The header is written after the layers, so a remap
+ * cut short by a reset or a power loss leaves a mix of old and new bytes
+ * that fails the second checksum and loads the compiled keymap instead.
+ */
+
+#define KEYMAP_STORE_VERSION 2
+
+typedef struct __attribute__((packed)) {
+    uint8_t  version;
+    uint8_t  layers;
+    uint16_t length;   // encoded bytes after the header
+    uint16_t checksum; // of the compiled keymap
+    uint16_t body_checksum;
+} keymap_store_header_t;
+
+void     keymap_store_init(void);
+bool     keymap_store_set(uint8_t layer, uint8_t row, uint8_t col, uint16_t keycode);
+void     keymap_store_reset(void);
+uint16_t keymap_store_encoded_size(void);
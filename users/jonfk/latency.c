@@ -0,0 +1,131 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "latency.h"
+#include "hid_bytes.h"
+#include "raw_hid.h"
+
+#if defined(PROTOCOL_CHIBIOS)
+#    include <hal.h>
+#endif
+
+_Static_assert((LATENCY_TRACE_SIZE & (LATENCY_TRACE_SIZE - 1)) == 0, "LATENCY_TRACE_SIZE must be a power of two");
+_Static_assert(2 + LATENCY_RECORDS_PER_PACKET * sizeof(latency_record_t) <= 32, "latency records do not fit a raw HID packet");
+
+#define CALIBRATION_MS 1000
+
+static latency_record_t trace[LATENCY_TRACE_SIZE];
+static uint16_t         head;
+static uint16_t         count;
+static uint16_t         dropped;
+
+static uint32_t calibration_ticks;
+static uint32_t calibration_start;
+static uint32_t ticks_per_ms;
+
+#if defined(PROTOCOL_CHIBIOS) && (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__))
+static void counter_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t counter_read(void) {
+    return DWT->CYCCNT;
+}
+#elif defined(PROTOCOL_CHIBIOS)
+static void counter_init(void) {}
+
+static inline uint32_t counter_read(void) {
+    return (uint32_t)chVTGetSystemTimeX();
+}
+#else
+static void counter_init(void) {}
+
+static inline uint32_t counter_read(void) {
+    return timer_read32();
+}
+#endif
+
+void latency_init(void) {
+    counter_init();
+    calibration_ticks = counter_read();
+    calibration_start = timer_read32();
+}
+
+void latency_task(void) {
+    // Measured once, over a second, so the 32-bit cycle counter cannot wrap.
+    if (ticks_per_ms == 0 && timer_elapsed32(calibration_start) >= CALIBRATION_MS) {
+        ticks_per_ms = (counter_read() - calibration_ticks) / timer_elapsed32(calibration_start);
+    }
+}
+
+void latency_mark(uint8_t stage, uint16_t keycode, keyrecord_t *record) {
+    uint32_t ticks = counter_read();
+    if (count == LATENCY_TRACE_SIZE) {
+        // Keep the oldest records so a burst stays complete until it is read.
+        dropped++;
+        return;
+    }
+    latency_record_t *r = &trace[(head + count) & (LATENCY_TRACE_SIZE - 1)];
+
+    r->ticks   = ticks;
+    r->stage   = stage;
+    r->key     = record->event.type == KEY_EVENT ? (record->event.key.row << 4 | record->event.key.col) : 0xFF;
+    r->keycode = keycode;
+    count++;
+}
+
+bool latency_raw_hid_receive(uint8_t *data, uint8_t length) {
+    if (length < 2 || data[0] != LATENCY_HID_ID) {
+        return false;
+    }
+    uint8_t command = data[1];
+    memset(data + 1, 0, length - 1);
+
+    switch (command) {
+        case LATENCY_HID_INFO:
+            put_u32(&data[1], ticks_per_ms);
+            put_u16(&data[5], LATENCY_TRACE_SIZE);
+            put_u16(&data[7], dropped);
+            break;
+        case LATENCY_HID_DRAIN: {
+            uint8_t n = MIN(count, LATENCY_RECORDS_PER_PACKET);
+            data[1]   = n;
+            for (uint8_t i = 0; i < n; i++) {
+                const latency_record_t *r = &trace[head];
+                uint8_t                *p = &data[2 + i * sizeof(latency_record_t)];
+
+                put_u32(p, r->ticks);
+                p[4] = r->stage;
+                p[5] = r->key;
+                put_u16(p + 6, r->keycode);
+                head = (head + 1) & (LATENCY_TRACE_SIZE - 1);
+                count--;
+            }
+            break;
+        }
+        case LATENCY_HID_CLEAR:
+            head    = 0;
+            count   = 0;
+            dropped = 0;
+            break;
+    }
+    raw_hid_send(data, length);
+    return true;
+}
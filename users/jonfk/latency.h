@@ -0,0 +1,66 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Key event latency trace, read back over raw HID.
+ *
+ * Every key event is timestamped with a free running counter as it passes
+ * the userspace hooks:
+ *
+ *   LATENCY_KEY      pre_process_record_user, the debounced matrix change
+ *   LATENCY_RESOLVED process_record_user entry, after combos and tap-hold
+ *   LATENCY_HANDLED  post_process_record_user, after the action has queued
+ *                    its HID report
+ *
+ * The records go into a RAM ring buffer that util/latency.py drains with
+ * LATENCY_HID_ID requests. The counter is the DWT cycle counter on
+ * Cortex-M3/M4/M7 and the ChibiOS system timer elsewhere; its rate is
+ * calibrated against timer_read32() so the host can convert to microseconds.
+ */
+
+enum latency_stage {
+    LATENCY_KEY = 0,
+    LATENCY_RESOLVED,
+    LATENCY_HANDLED,
+};
+
+/* Raw HID packets starting with this byte belong to the latency trace. */
+#define LATENCY_HID_ID 0x4C
+
+enum latency_hid_command {
+    LATENCY_HID_INFO  = 0, // reply: counter ticks per ms (u32), capacity (u16), dropped records (u16)
+    LATENCY_HID_DRAIN = 1, // reply: record count (u8), then up to LATENCY_RECORDS_PER_PACKET records
+    LATENCY_HID_CLEAR = 2,
+};
+
+/* One trace record as sent to the host, little-endian. */
+typedef struct __attribute__((packed)) {
+    uint32_t ticks;
+    uint8_t  stage;
+    uint8_t  key; // row << 4 | col, 0xFF for combo events
+    uint16_t keycode;
+} latency_record_t;
+
+#define LATENCY_RECORDS_PER_PACKET 3
+
+void latency_init(void);
+void latency_task(void);
+void latency_mark(uint8_t stage, uint16_t keycode, keyrecord_t *record);
+bool latency_raw_hid_receive(uint8_t *data, uint8_t length);
@@ -0,0 +1,125 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "layer_lights.h"
+
+#define LED_BITMAP_SIZE ((RGB_MATRIX_LED_COUNT + 7) / 8)
+#define UNLIT 0xFF
+
+static uint8_t       layer_leds[MAX_LAYER][LED_BITMAP_SIZE]; // LEDs whose key is not KC_TRNS on the layer
+static layer_state_t lit_layers;
+static RGB           layer_rgb[MAX_LAYER];
+static uint8_t       layer_count;
+
+static uint8_t       lit_layer[RGB_MATRIX_LED_COUNT];
+static uint8_t       dirty[LED_BITMAP_SIZE];
+static layer_state_t shown_state;
+static uint8_t       shown_val;
+
+static inline bool led_test(const uint8_t *bitmap, uint8_t led) {
+    return bitmap[led / 8] & (1 << (led % 8));
+}
+
+__attribute__((weak)) HSV layer_lights_color_keymap(uint8_t layer) {
+    return (HSV){0, 0, 0};
+}
+
+static void update_colors(uint8_t val) {
+    for (uint8_t layer = 0; layer < layer_count; layer++) {
+        HSV hsv          = layer_lights_color_keymap(layer);
+        hsv.v            = (uint16_t)hsv.v * val / UINT8_MAX;
+        layer_rgb[layer] = hsv_to_rgb(hsv);
+    }
+    shown_val = val;
+}
+
+static uint8_t resolve(uint8_t led, layer_state_t state) {
+    for (int8_t layer = layer_count - 1; layer >= 0; layer--) {
+        if ((state & ((layer_state_t)1 << layer)) && led_test(layer_leds[layer], led)) {
+            return (lit_layers & ((layer_state_t)1 << layer)) ? layer : UNLIT;
+        }
+    }
+    return UNLIT;
+}
+
+static void find_layer_leds(void) {
+    memset(layer_leds, 0, sizeof(layer_leds));
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t led = g_led_config.matrix_co[row][col];
+            if (led == NO_LED) {
+                continue;
+            }
+            for (uint8_t layer = 0; layer < layer_count; layer++) {
+                if (keycode_at_keymap_location(layer, row, col) != KC_TRNS) {
+                    layer_leds[layer][led / 8] |= 1 << (led % 8);
+                }
+            }
+        }
+    }
+}
+
+void layer_lights_init(void) {
+    layer_count = MIN(keymap_layer_count(), MAX_LAYER);
+    lit_layers  = 0;
+    find_layer_leds();
+    for (uint8_t layer = 0; layer < layer_count; layer++) {
+        if (layer_lights_color_keymap(layer).v) {
+            lit_layers |= (layer_state_t)1 << layer;
+        }
+    }
+    update_colors(rgb_matrix_get_val());
+    memset(lit_layer, UNLIT, sizeof(lit_layer));
+    memset(dirty, 0xFF, sizeof(dirty));
+    shown_state = 0;
+}
+
+void layer_lights_keymap_changed(void) {
+    find_layer_leds();
+    memset(dirty, 0xFF, sizeof(dirty));
+}
+
+void layer_lights_render(uint8_t led_min, uint8_t led_max) {
+    layer_state_t state = layer_state | default_layer_state;
+    if (state != shown_state) {
+        // Only keys bound on a layer that changed can resolve differently.
+        layer_state_t changed = state ^ shown_state;
+        for (uint8_t layer = 0; layer < layer_count; layer++) {
+            if (changed & ((layer_state_t)1 << layer)) {
+                for (uint8_t i = 0; i < LED_BITMAP_SIZE; i++) {
+                    dirty[i] |= layer_leds[layer][i];
+                }
+            }
+        }
+        shown_state = state;
+    }
+    if (rgb_matrix_get_val() != shown_val) {
+        update_colors(rgb_matrix_get_val());
+    }
+
+    for (uint8_t led = led_min; led < led_max; led++) {
+        if (led_test(dirty, led)) {
+            lit_layer[led] = resolve(led, state);
+            dirty[led / 8] &= ~(1 << (led % 8));
+        }
+        if (lit_layer[led] != UNLIT) {
+            RGB rgb = layer_rgb[lit_layer[led]];
+            rgb_matrix_set_color(led, rgb.r, rgb.g, rgb.b);
+        }
+    }
+}
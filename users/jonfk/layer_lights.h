@@ -0,0 +1,46 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Layer indicators on the RGB matrix.
+ *
+ * Each key lights in the colour of the layer it is bound on, if that is the
+ * highest active layer that binds it and the layer has a colour. The colour
+ * is drawn on top of the running effect. The layer that lights each LED is
+ * cached. After a layer change it is only recomputed for LEDs whose key is
+ * bound on a layer that changed, and only within the slice rgb_matrix is
+ * rendering. RGB_MATRIX_LED_PROCESS_LIMIT therefore bounds the indicator
+ * work per scan just as it bounds the effect.
+ *
+ * Layer changes are picked up from the render itself rather than from
+ * layer_state_set_user. That way the slave half follows the layers that
+ * split_sync.c writes directly.
+ */
+
+/* Colour of a layer's keys; a layer with a zero value stays unlit. */
+HSV layer_lights_color_keymap(uint8_t layer);
+
+void layer_lights_init(void);
+
+/* Finds the keys each layer binds again, after a remap */
+void layer_lights_keymap_changed(void);
+
+/* Runs from rgb_matrix_indicators_advanced_user */
+void layer_lights_render(uint8_t led_min, uint8_t led_max);
@@ -0,0 +1,67 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "macro_queue.h"
+
+_Static_assert((MACRO_QUEUE_SIZE & (MACRO_QUEUE_SIZE - 1)) == 0, "MACRO_QUEUE_SIZE must be a power of two");
+
+static uint16_t queue[MACRO_QUEUE_SIZE];
+static uint8_t  head;
+static uint8_t  count;
+static bool     pressed; // the keycode at the head has been sent down
+static uint16_t last_send;
+
+static uint8_t weak_mods_of(uint16_t keycode) {
+    uint8_t mods = IS_QK_MODS(keycode) ? QK_MODS_GET_MODS(keycode) : 0;
+    // Right-hand mods are flagged by bit 4 and use the upper nibble of the report.
+    return (mods & 0x10) ? (uint8_t)((mods & 0x0F) << 4) : mods;
+}
+
+bool macro_queue_tap16(uint16_t keycode) {
+    if (count == MACRO_QUEUE_SIZE) {
+        return false;
+    }
+    queue[(head + count) & (MACRO_QUEUE_SIZE - 1)] = keycode;
+    count++;
+    return true;
+}
+
+bool macro_queue_is_empty(void) {
+    return count == 0;
+}
+
+void macro_queue_task(void) {
+    // One report per USB frame so the endpoint is free again by the time
+    // the next one is submitted.
+    if (count == 0 || timer_read() == last_send) {
+        return;
+    }
+    uint16_t keycode = queue[head];
+    uint8_t  code    = QK_MODS_GET_BASIC_KEYCODE(keycode);
+
+    if (!pressed) {
+        add_weak_mods(weak_mods_of(keycode));
+        register_code(code);
+        pressed = true;
+    } else {
+        del_weak_mods(weak_mods_of(keycode));
+        unregister_code(code);
+        pressed = false;
+        head    = (head + 1) & (MACRO_QUEUE_SIZE - 1);
+        count--;
+    }
+    last_send = timer_read();
+}
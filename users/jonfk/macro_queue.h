@@ -0,0 +1,35 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Macro output that never blocks the matrix scan.
+ *
+ * SEND_STRING(SS_LCTL("c")) emits four reports back to back from inside
+ * process_record_user, each waiting on the USB endpoint. Here a macro is a
+ * list of 16-bit keycodes queued for the housekeeping task, which emits at
+ * most one report per millisecond: the modifiers and the key go out together
+ * in the press report and are dropped together in the release report, so
+ * LCTL(KC_C) costs two reports. Keys typed while a macro is draining are
+ * processed as usual in between.
+ */
+
+bool macro_queue_tap16(uint16_t keycode);
+void macro_queue_task(void);
+bool macro_queue_is_empty(void);
@@ -0,0 +1,160 @@
+SRC += jonfk.c user_keycodes.c
+
+# Decide bottom-row mod-taps from typing rhythm and hand instead of waiting on TAPPING_TERM
+PREDICTIVE_TAP_HOLD_ENABLE ?= yes
+
+ifeq ($(strip $(PREDICTIVE_TAP_HOLD_ENABLE)), yes)
+    SRC += tap_hold.c
+    OPT_DEFS += -DPREDICTIVE_TAP_HOLD_ENABLE
+endif
+
+# Learn a tapping term per mod-tap position and keep it in the user EEPROM datablock
+TAPPING_TERM_TUNER_ENABLE ?= yes
+
+ifeq ($(strip $(TAPPING_TERM_TUNER_ENABLE)), yes)
+    SRC += tapping_term.c
+    OPT_DEFS += -DTAPPING_TERM_TUNER_ENABLE
+endif
+
+# Replace triggers typed on the Dvorak layer with their text from expansions.txt, matched through a trie in flash
+TEXT_EXPANSION_ENABLE ?= no
+
+ifeq ($(strip $(TEXT_EXPANSION_ENABLE)), yes)
+    MACRO_QUEUE_ENABLE = yes
+    SRC += text_expansion.c
+    OPT_DEFS += -DTEXT_EXPANSION_ENABLE
+endif
+
+# Feed macro keystrokes to the host from the main loop instead of blocking in process_record
+MACRO_QUEUE_ENABLE ?= yes
+
+ifeq ($(strip $(MACRO_QUEUE_ENABLE)), yes)
+    SRC += macro_queue.c
+    OPT_DEFS += -DMACRO_QUEUE_ENABLE
+endif
+
+# Keep the default layer in RAM and write it to EEPROM when idle
+SETTINGS_CACHE_ENABLE ?= yes
+
+ifeq ($(strip $(SETTINGS_CACHE_ENABLE)), yes)
+    TIMER_WHEEL_ENABLE = yes
+    SRC += settings.c
+    OPT_DEFS += -DSETTINGS_CACHE_ENABLE
+endif
+
+# Scroll from the encoder map through the pointing device report, batched and accelerated
+ENCODER_SCROLL_ENABLE ?= no
+
+ifeq ($(strip $(ENCODER_SCROLL_ENABLE)), yes)
+    POINTING_DEVICE_ENABLE = yes
+    POINTING_DEVICE_DRIVER = custom
+    SRC += encoder_scroll.c
+    OPT_DEFS += -DENCODER_SCROLL_ENABLE
+endif
+
+# Play semitones from the encoder map, pitched from integer 12-TET and just intonation tables
+ENCODER_NOTES_ENABLE ?= no
+
+ifeq ($(strip $(ENCODER_NOTES_ENABLE)), yes)
+    AUDIO_ENABLE = yes
+    SRC += encoder_notes.c
+    OPT_DEFS += -DENCODER_NOTES_ENABLE
+endif
+
+# Generate DAC samples from a wavetable at a fixed cost per sample, and meter the scan rate while audio plays
+WAVETABLE_AUDIO_ENABLE ?= no
+
+ifeq ($(strip $(WAVETABLE_AUDIO_ENABLE)), yes)
+    AUDIO_ENABLE = yes
+    AUDIO_DRIVER = dac_additive
+    RAW_ENABLE = yes
+    SRC += wavetable.c
+    OPT_DEFS += -DWAVETABLE_AUDIO_ENABLE
+endif
+
+# Debounce each key on its own, pressing on first contact and releasing after DEBOUNCE ms open
+EAGER_DEBOUNCE_ENABLE ?= no
+
+ifeq ($(strip $(EAGER_DEBOUNCE_ENABLE)), yes)
+    DEBOUNCE_TYPE = custom
+    SRC += eager_debounce.c
+    OPT_DEFS += -DEAGER_DEBOUNCE_ENABLE
+endif
+
+# Send layers and mods to the other half as deltas over one split transaction, only when they change
+SPLIT_SYNC_ENABLE ?= no
+
+ifeq ($(strip $(SPLIT_SYNC_ENABLE)), yes)
+    SRC += split_sync.c
+    OPT_DEFS += -DSPLIT_SYNC_ENABLE
+endif
+
+# Light the keys of the active layer on the RGB matrix, recomputing only what a layer change touches
+LAYER_LIGHTS_ENABLE ?= no
+
+ifeq ($(strip $(LAYER_LIGHTS_ENABLE)), yes)
+    RGB_MATRIX_ENABLE = yes
+    SRC += layer_lights.c
+    OPT_DEFS += -DLAYER_LIGHTS_ENABLE
+endif
+
+# Pace the main loop once the matrix has been still, waking on the first change within one fast-scan period
+ADAPTIVE_SCAN_ENABLE ?= no
+
+ifeq ($(strip $(ADAPTIVE_SCAN_ENABLE)), yes)
+    SRC += adaptive_scan.c
+    OPT_DEFS += -DADAPTIVE_SCAN_ENABLE
+endif
+
+# Run deferred callbacks from a timer wheel, for when more timers are pending than defer_exec scans comfortably
+TIMER_WHEEL_ENABLE ?= no
+
+ifeq ($(strip $(TIMER_WHEEL_ENABLE)), yes)
+    SRC += timer_wheel.c
+    OPT_DEFS += -DTIMER_WHEEL_ENABLE
+endif
+
+# Count key presses per layer, mod-tap bigrams and the typing rate, checkpoint them to EEPROM and serve them over raw HID (see util/heatmap.py)
+HEATMAP_ENABLE ?= no
+
+ifeq ($(strip $(HEATMAP_ENABLE)), yes)
+    RAW_ENABLE = yes
+    SRC += heatmap.c
+    OPT_DEFS += -DHEATMAP_ENABLE
+endif
+
+# Keep the keymap in RAM, remappable over raw HID and stored run-length encoded in the user EEPROM datablock
+KEYMAP_STORE_ENABLE ?= no
+
+ifeq ($(strip $(KEYMAP_STORE_ENABLE)), yes)
+    HID_COMMAND_ENABLE = yes
+    SRC += keymap_store.c
+    OPT_DEFS += -DKEYMAP_STORE_ENABLE
+endif
+
+# Query state, switch the default layer and replace the MA_* macros over raw HID (see util/hid_command.py)
+HID_COMMAND_ENABLE ?= no
+
+ifeq ($(strip $(HID_COMMAND_ENABLE)), yes)
+    RAW_ENABLE = yes
+    SRC += hid_command.c
+    OPT_DEFS += -DHID_COMMAND_ENABLE
+endif
+
+# Timestamp key events through the userspace hooks and serve them over raw HID (see util/latency.py)
+LATENCY_TRACE_ENABLE ?= no
+
+ifeq ($(strip $(LATENCY_TRACE_ENABLE)), yes)
+    RAW_ENABLE = yes
+    SRC += latency.c
+    OPT_DEFS += -DLATENCY_TRACE_ENABLE
+endif
+
+# Log through TLOG() as token numbers and varint arguments, sent to the console when idle and decoded by util/tlog.py
+TLOG_ENABLE ?= no
+
+ifeq ($(strip $(TLOG_ENABLE)), yes)
+    CONSOLE_ENABLE = yes
+    SRC += tlog.c
+    OPT_DEFS += -DTLOG_ENABLE
+endif
@@ -0,0 +1,76 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "settings.h"
+#include "timer_wheel.h"
+
+#if defined(AUDIO_ENABLE) && defined(DEFAULT_LAYER_SONGS)
+extern float default_layer_songs[][16][2];
+
+// The core defines the table from the same initializer, without exporting its length.
+#    define DEFAULT_LAYER_SONG_COUNT (sizeof((float[][16][2])DEFAULT_LAYER_SONGS) / sizeof(float[16][2]))
+#endif
+
+static layer_state_t       stored_default_layer;
+static layer_state_t       current_default_layer;
+static bool                dirty;
+static timer_wheel_token_t flush_timer;
+
+void settings_init(void) {
+    stored_default_layer  = eeconfig_read_default_layer();
+    current_default_layer = stored_default_layer;
+}
+
+static uint32_t flush_deferred(uint32_t trigger_time, void *cb_arg) {
+    settings_flush();
+    return 0;
+}
+
+static void settings_changed(void) {
+    dirty = true;
+    // Every change pushes the write back by the whole delay.
+    timer_wheel_cancel(flush_timer);
+    flush_timer = timer_wheel_schedule(SETTINGS_FLUSH_DELAY, flush_deferred, NULL);
+    if (flush_timer == TIMER_WHEEL_INVALID_TOKEN) {
+        // No timer left; write now rather than never.
+        settings_flush();
+    }
+}
+
+void settings_set_default_layer(uint8_t layer) {
+#if defined(AUDIO_ENABLE) && defined(DEFAULT_LAYER_SONGS)
+    // Layers come from raw HID too; there may be more of them than songs.
+    if (layer < DEFAULT_LAYER_SONG_COUNT) {
+        PLAY_SONG(default_layer_songs[layer]);
+    }
+#endif
+    current_default_layer = (layer_state_t)1 << layer;
+    default_layer_set(current_default_layer);
+    settings_changed();
+}
+
+void settings_flush(void) {
+    timer_wheel_cancel(flush_timer);
+    if (!dirty) {
+        return;
+    }
+    // Only if it differs from the last write; a layer switched back costs nothing.
+    if (current_default_layer != stored_default_layer) {
+        eeconfig_update_default_layer(current_default_layer);
+    }
+    stored_default_layer = current_default_layer;
+    dirty                = false;
+}
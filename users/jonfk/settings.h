@@ -0,0 +1,33 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Persistent settings changed from the keymap, written back lazily.
+ *
+ * The default layer takes effect in RAM as soon as it is changed; the EEPROM
+ * copy is only updated once it has not changed for SETTINGS_FLUSH_DELAY ms,
+ * from a timer on the timer wheel, or before a reboot.
+ * Switching back and forth in between costs no writes at all, and the
+ * blocking flash write never happens inside key processing.
+ */
+
+void settings_init(void);
+void settings_flush(void);
+void settings_set_default_layer(uint8_t layer);
@@ -0,0 +1,156 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "split_sync.h"
+#include "transactions.h"
+
+typedef struct __attribute__((packed)) {
+    layer_state_t layers;
+    layer_state_t default_layers;
+    uint8_t       mods;
+    uint8_t       weak_mods;
+    uint8_t       oneshot_mods;
+} split_sync_state_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  seq;
+    uint8_t  base;    // sequence number the delta applies to, 0 for the zero state
+    uint16_t changed; // bit n set: the next value is byte n of the state
+    uint8_t  values[sizeof(split_sync_state_t)];
+} split_sync_frame_t;
+
+_Static_assert(sizeof(split_sync_state_t) <= 16, "split_sync_state_t does not fit the changed bitmap");
+_Static_assert(sizeof(split_sync_frame_t) <= RPC_M2S_BUFFER_SIZE, "split_sync_frame_t does not fit a split transaction");
+
+#define FRAME_HEADER_SIZE offsetof(split_sync_frame_t, values)
+
+// Master: what the slave holds, and the last sequence number handed out.
+static split_sync_state_t acked;
+static uint8_t            acked_seq;
+static uint8_t            last_seq;
+static uint16_t           last_exchange;
+
+// Slave: the state applied so far.
+static split_sync_state_t slave_state;
+static uint8_t            slave_seq;
+
+static uint8_t encode(split_sync_frame_t *frame, const split_sync_state_t *from, const split_sync_state_t *to) {
+    const uint8_t *a = (const uint8_t *)from;
+    const uint8_t *b = (const uint8_t *)to;
+    uint8_t        n = 0;
+
+    frame->changed = 0;
+    for (uint8_t i = 0; i < sizeof(split_sync_state_t); i++) {
+        if (a[i] != b[i]) {
+            frame->changed |= (uint16_t)1 << i;
+            frame->values[n++] = b[i];
+        }
+    }
+    return FRAME_HEADER_SIZE + n;
+}
+
+static bool decode(const split_sync_frame_t *frame, uint8_t length, split_sync_state_t *state) {
+    uint8_t *bytes = (uint8_t *)state;
+    uint8_t  n     = 0;
+
+    if (frame->changed >> sizeof(split_sync_state_t)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(split_sync_state_t); i++) {
+        if (frame->changed & ((uint16_t)1 << i)) {
+            if (FRAME_HEADER_SIZE + n >= length) {
+                return false;
+            }
+            bytes[i] = frame->values[n++];
+        }
+    }
+    return FRAME_HEADER_SIZE + n == length;
+}
+
+static void slave_handler(uint8_t in_length, const void *in_data, uint8_t out_length, void *out_data) {
+    const split_sync_frame_t *frame = in_data;
+
+    if (in_length >= FRAME_HEADER_SIZE && (frame->base == 0 || frame->base == slave_seq)) {
+        split_sync_state_t state = slave_state;
+        if (frame->base == 0) {
+            memset(&state, 0, sizeof(state));
+        }
+        if (decode(frame, in_length, &state)) {
+            slave_state         = state;
+            slave_seq           = frame->seq;
+            layer_state         = state.layers;
+            default_layer_state = state.default_layers;
+            set_mods(state.mods);
+            set_weak_mods(state.weak_mods);
+            set_oneshot_mods(state.oneshot_mods);
+        }
+    }
+    *(uint8_t *)out_data = slave_seq;
+}
+
+void split_sync_init(void) {
+    if (is_keyboard_master()) {
+        memset(&acked, 0, sizeof(acked));
+        acked_seq = 0;
+    } else {
+        memset(&slave_state, 0, sizeof(slave_state));
+        slave_seq = 0;
+    }
+    transaction_register_rpc(USER_SPLIT_SYNC, slave_handler);
+}
+
+void split_sync_task(void) {
+    if (!is_keyboard_master() || !is_transport_connected()) {
+        return;
+    }
+
+    split_sync_state_t current = {
+        .layers         = layer_state,
+        .default_layers = default_layer_state,
+        .mods           = get_mods(),
+        .weak_mods      = get_weak_mods(),
+        .oneshot_mods   = get_oneshot_mods(),
+    };
+    bool changed = memcmp(&current, &acked, sizeof(current)) != 0;
+    if (!changed && timer_elapsed(last_exchange) < SPLIT_SYNC_KEEPALIVE_MS) {
+        return;
+    }
+
+    split_sync_frame_t frame;
+    frame.base = acked_seq;
+    frame.seq  = acked_seq;
+    if (changed) {
+        // Never reused while a frame may still be applied, and never 0.
+        last_seq  = last_seq == UINT8_MAX ? 1 : last_seq + 1;
+        frame.seq = last_seq;
+    }
+    uint8_t length = encode(&frame, &acked, &current);
+    uint8_t reply;
+
+    last_exchange = timer_read();
+    if (!transaction_rpc_exec(USER_SPLIT_SYNC, length, &frame, sizeof(reply), &reply)) {
+        return;
+    }
+    if (reply == frame.seq) {
+        acked     = current;
+        acked_seq = frame.seq;
+    } else {
+        memset(&acked, 0, sizeof(acked));
+        acked_seq = 0;
+    }
+}
@@ -0,0 +1,41 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Layer and modifier state for the other half, sent as deltas.
+ *
+ * Replaces the core's SPLIT_LAYER_STATE_ENABLE and SPLIT_MODS_ENABLE, which
+ * use one transaction each and resend the full state every 100 ms. Here the
+ * master sends one frame over a user split transaction, and only when the
+ * state changes or every SPLIT_SYNC_KEEPALIVE_MS. A frame carries just the
+ * bytes that differ from the state the slave last acknowledged.
+ *
+ * Each frame names the sequence number it is based on, and the slave only
+ * applies it on top of that state. It replies with the sequence number it
+ * holds. A dropped frame is simply sent again as a delta against the same
+ * base. When the slave holds anything else, because it restarted or its
+ * reply was lost, the master resends the full state from base 0.
+ */
+
+/* Registers the transaction handler, on both halves */
+void split_sync_init(void);
+
+/* Runs from housekeeping; sends the master's state when needed */
+void split_sync_task(void);
@@ -0,0 +1,114 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jonfk.h"
+
+// Average gap between typing presses, in 1/16 ms.
+#define INTERVAL_SHIFT 4
+
+static uint16_t last_press_time;
+static bool     last_press_typing;
+static uint16_t typing_interval = TYPING_STREAK_TERM << INTERVAL_SHIFT;
+
+static keypos_t     tap_hold_key;
+static bool         tap_hold_down;
+static bool         interrupted_same_hand;
+static matrix_row_t instant_taps[MATRIX_ROWS];
+
+__attribute__((weak)) bool is_typing_keycode(uint16_t keycode) {
+    if (IS_QK_MOD_TAP(keycode)) {
+        keycode = mod_tap_get_tap_keycode(keycode);
+    }
+    // Shifted symbols type like their unshifted key.
+    if (IS_QK_MODS(keycode) && QK_MODS_GET_MODS(keycode) == MOD_LSFT) {
+        keycode = QK_MODS_GET_BASIC_KEYCODE(keycode);
+    }
+    return (keycode >= KC_A && keycode <= KC_0) || (keycode >= KC_SPC && keycode <= KC_SLSH);
+}
+
+bool is_left_hand(keypos_t key) {
+    // Both boards are wired as two 4x6 halves, the right half in the high rows.
+    return key.row < MATRIX_ROWS / 2;
+}
+
+/*
+ * The streak window follows the typist: twice the recent average gap between
+ * presses, capped at TYPING_STREAK_TERM and never below half of it.
+ */
+static uint16_t typing_streak_term(void) {
+    uint16_t term = (typing_interval >> INTERVAL_SHIFT) * 2;
+    if (term > TYPING_STREAK_TERM) {
+        return TYPING_STREAK_TERM;
+    }
+    if (term < TYPING_STREAK_TERM / 2) {
+        return TYPING_STREAK_TERM / 2;
+    }
+    return term;
+}
+
+static void update_typing_interval(uint16_t elapsed) {
+    uint16_t sample = elapsed << INTERVAL_SHIFT;
+    if (sample > typing_interval) {
+        typing_interval += (sample - typing_interval) >> 2;
+    } else {
+        typing_interval -= (typing_interval - sample) >> 2;
+    }
+}
+
+uint16_t pre_process_predictive_tap_hold(uint16_t keycode, keyrecord_t *record) {
+    keypos_t key = record->event.key;
+
+    if (!record->event.pressed) {
+        if (instant_taps[key.row] & ((matrix_row_t)1 << key.col)) {
+            instant_taps[key.row] &= ~((matrix_row_t)1 << key.col);
+            record->keycode = mod_tap_get_tap_keycode(keycode);
+            return record->keycode;
+        }
+        if (tap_hold_down && key.row == tap_hold_key.row && key.col == tap_hold_key.col) {
+            tap_hold_down = false;
+        }
+        return keycode;
+    }
+
+    uint16_t elapsed   = TIMER_DIFF_16(record->event.time, last_press_time);
+    bool     in_streak = last_press_typing && elapsed < typing_streak_term() && !(get_mods() & MOD_MASK_CAG);
+
+    if (IS_QK_MOD_TAP(keycode) && in_streak && is_typing_keycode(keycode)) {
+        instant_taps[key.row] |= (matrix_row_t)1 << key.col;
+        record->keycode = mod_tap_get_tap_keycode(keycode);
+        keycode         = record->keycode;
+    }
+
+    if (tap_hold_down) {
+        interrupted_same_hand |= is_left_hand(key) == is_left_hand(tap_hold_key);
+    } else if (IS_QK_MOD_TAP(keycode)) {
+        tap_hold_key          = key;
+        tap_hold_down         = true;
+        interrupted_same_hand = false;
+    }
+
+    if (last_press_typing && elapsed < TYPING_STREAK_TERM * 2) {
+        update_typing_interval(elapsed);
+    }
+    last_press_typing = is_typing_keycode(keycode);
+    last_press_time   = record->event.time;
+    return keycode;
+}
+
+bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) {
+    // A key from the same hand nested inside a mod-tap is a fast roll.
+    return !interrupted_same_hand;
+}
@@ -0,0 +1,37 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Predictive tap-hold for mod-taps.
+ *
+ * A mod-tap pressed during a typing streak is turned into its tap keycode
+ * before it reaches the tap-hold engine, so it is sent on press instead of
+ * on release. Outside a streak the core still decides, but permissive hold
+ * only applies when the interrupting key is on the other hand: same-hand
+ * nested presses are rolls, opposite-hand ones are shortcuts.
+ */
+
+/* Runs from pre_process_record_user; returns the keycode to carry on with. */
+uint16_t pre_process_predictive_tap_hold(uint16_t keycode, keyrecord_t *record);
+
+/* Keys that keep a typing streak going. Mod-taps are judged by their tap keycode. */
+bool is_typing_keycode(uint16_t keycode);
+
+bool is_left_hand(keypos_t key);
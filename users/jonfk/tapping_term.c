@@ -0,0 +1,168 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "tapping_term.h"
+#include "tlog.h"
+
+#define TUNER_VERSION 1
+#define TUNER_KEYS (MATRIX_ROWS * MATRIX_COLS)
+#define TUNER_MAX_DOWN 4
+
+// Estimates are kept in 1/16 ms; one step is a quarter of a millisecond.
+#define QUANTILE_SHIFT 4
+#define QUANTILE_STEP 4
+// Up/down step ratio of 19:1 settles where 1 sample in 20 lies above the estimate.
+#define QUANTILE_UP (19 * QUANTILE_STEP)
+
+typedef struct {
+    uint8_t version;
+    uint8_t terms[TUNER_KEYS]; // in TAPPING_TERM_TUNER_UNIT ms, 0 when not tuned yet
+} tuned_terms_t;
+
+_Static_assert(sizeof(tuned_terms_t) <= TAPPING_TERM_TUNER_DATA_SIZE, "TAPPING_TERM_TUNER_DATA_SIZE too small for tuned tapping terms");
+
+typedef struct {
+    keypos_t key;
+    uint16_t time;
+    uint8_t  presses;
+    bool     used;
+} mod_tap_down_t;
+
+static tuned_terms_t  tuned;
+static uint16_t       estimate[TUNER_KEYS];
+static uint8_t        samples[TUNER_KEYS];
+static mod_tap_down_t down[TUNER_MAX_DOWN];
+static uint8_t        press_counter;
+static bool           dirty;
+static uint32_t       last_activity;
+static uint32_t       last_save;
+
+static uint8_t key_index(keypos_t key) {
+    return key.row * MATRIX_COLS + key.col;
+}
+
+static uint8_t term_to_units(uint16_t term) {
+    return (term + TAPPING_TERM_TUNER_UNIT / 2) / TAPPING_TERM_TUNER_UNIT;
+}
+
+void tapping_term_tuner_init(void) {
+    eeconfig_read_user_datablock(&tuned, 0, sizeof(tuned));
+    if (tuned.version != TUNER_VERSION) {
+        memset(&tuned, 0, sizeof(tuned));
+        tuned.version = TUNER_VERSION;
+    }
+    // Resume learning from the stored terms instead of from scratch.
+    for (uint8_t i = 0; i < TUNER_KEYS; i++) {
+        if (tuned.terms[i]) {
+            estimate[i] = (tuned.terms[i] * TAPPING_TERM_TUNER_UNIT - TAPPING_TERM_TUNER_MARGIN) << QUANTILE_SHIFT;
+            samples[i]  = TAPPING_TERM_TUNER_MIN_SAMPLES;
+        }
+    }
+}
+
+uint16_t tapping_term_tuner_get(keypos_t key) {
+    uint8_t units = tuned.terms[key_index(key)];
+    return units ? units * TAPPING_TERM_TUNER_UNIT : TAPPING_TERM;
+}
+
+static void add_sample(keypos_t key, uint16_t duration) {
+    uint8_t  i = key_index(key);
+    uint16_t x = MIN(duration, TAPPING_TERM_TUNER_MAX) << QUANTILE_SHIFT;
+
+    if (samples[i] == 0) {
+        estimate[i] = x;
+    } else if (x > estimate[i]) {
+        estimate[i] += MIN(QUANTILE_UP, x - estimate[i]);
+    } else if (x < estimate[i]) {
+        estimate[i] -= MIN(QUANTILE_STEP, estimate[i] - x);
+    }
+    if (samples[i] < UINT8_MAX) {
+        samples[i]++;
+    }
+    if (samples[i] < TAPPING_TERM_TUNER_MIN_SAMPLES) {
+        return;
+    }
+
+    uint16_t term  = (estimate[i] >> QUANTILE_SHIFT) + TAPPING_TERM_TUNER_MARGIN;
+    uint8_t  units = term_to_units(MAX(TAPPING_TERM_TUNER_MIN, MIN(term, TAPPING_TERM_TUNER_MAX)));
+    if (units != tuned.terms[i]) {
+        tuned.terms[i] = units;
+        dirty          = true;
+        TLOG(TAPPING_TERM, key.row, key.col, units * TAPPING_TERM_TUNER_UNIT);
+    }
+}
+
+void pre_process_tapping_term_tuner(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) {
+        return;
+    }
+    press_counter++;
+    last_activity = timer_read32();
+    if (!IS_QK_MOD_TAP(keycode)) {
+        return;
+    }
+
+    mod_tap_down_t *slot = &down[0];
+    for (uint8_t i = 0; i < TUNER_MAX_DOWN; i++) {
+        if (!down[i].used || (down[i].key.row == record->event.key.row && down[i].key.col == record->event.key.col)) {
+            slot = &down[i];
+            break;
+        }
+        if (TIMER_DIFF_16(down[i].time, slot->time) > 0x8000) {
+            slot = &down[i]; // evict the oldest
+        }
+    }
+    *slot = (mod_tap_down_t){.key = record->event.key, .time = record->event.time, .presses = press_counter, .used = true};
+}
+
+void post_process_tapping_term_tuner(uint16_t keycode, keyrecord_t *record) {
+    if (record->event.pressed) {
+        return;
+    }
+    for (uint8_t i = 0; i < TUNER_MAX_DOWN; i++) {
+        if (!down[i].used || down[i].key.row != record->event.key.row || down[i].key.col != record->event.key.col) {
+            continue;
+        }
+        down[i].used = false;
+
+        // Rewritten to its tap keycode by the predictive tap-hold, or resolved
+        // as a tap by the core: a tap either way. A hold that never saw another
+        // key press and let go within the term was meant as a tap too. One held
+        // past it may be a modifier for a mouse click, so it tells nothing.
+        uint16_t duration = TIMER_DIFF_16(record->event.time, down[i].time);
+        bool     tap      = !IS_QK_MOD_TAP(keycode) || record->tap.count > 0;
+        bool     lonely   = down[i].presses == press_counter && duration < tapping_term_tuner_get(record->event.key);
+        if (tap || lonely) {
+            add_sample(record->event.key, duration);
+        }
+        return;
+    }
+}
+
+void tapping_term_tuner_task(void) {
+    if (!dirty || timer_elapsed32(last_activity) < TAPPING_TERM_TUNER_IDLE_MS || timer_elapsed32(last_save) < TAPPING_TERM_TUNER_SAVE_INTERVAL) {
+        return;
+    }
+    eeconfig_update_user_datablock(&tuned, 0, sizeof(tuned));
+    dirty     = false;
+    last_save = timer_read32();
+}
+
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+    return tapping_term_tuner_get(record->event.key);
+}
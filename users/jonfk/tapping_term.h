@@ -0,0 +1,37 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Per-key tapping term learned from how long each mod-tap is held when it is
+ * meant as a tap.
+ *
+ * Every matrix position carries a streaming 95th percentile estimate of its
+ * tap durations (two bytes, Frugal-1U style). Holds released without any
+ * other key pressed count as taps that ran long, which pushes the estimate
+ * up after a misfire. The tuned term is the estimate plus a margin, clamped
+ * to [TAPPING_TERM_TUNER_MIN, TAPPING_TERM_TUNER_MAX], and is written to the
+ * user EEPROM datablock once the keyboard has been idle for a while.
+ */
+
+void     tapping_term_tuner_init(void);
+void     tapping_term_tuner_task(void);
+void     pre_process_tapping_term_tuner(uint16_t keycode, keyrecord_t *record);
+void     post_process_tapping_term_tuner(uint16_t keycode, keyrecord_t *record);
+uint16_t tapping_term_tuner_get(keypos_t key);
@@ -0,0 +1,213 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jonfk.h"
+#include EXPANSIONS_DATA_H
+
+#ifndef MACRO_QUEUE_ENABLE
+#    error "TEXT_EXPANSION_ENABLE needs MACRO_QUEUE_ENABLE"
+#endif
+
+_Static_assert((TEXT_EXPANSION_QUEUE_SIZE & (TEXT_EXPANSION_QUEUE_SIZE - 1)) == 0, "TEXT_EXPANSION_QUEUE_SIZE must be a power of two");
+
+// Node layout, see util/compile_expansions.py
+#define NODE_TERMINAL 0x80
+#define NODE_CHILDREN 0x40
+#define TEXT_SHIFT 0x80
+
+#define NO_NODE 0xFFFF
+#define NO_TEXT 0xFFFF
+// Keys typed since the match failed; at DEAD_WORD the word can no longer match.
+#define DEAD_WORD 0xFF
+
+typedef struct {
+    uint16_t text; // NO_TEXT for a key typed while output was pending
+    uint16_t keycode;
+    uint8_t  backspaces;
+} expansion_op_t;
+
+static uint16_t       path[EXPANSION_MAX_TRIGGER + 1]; // path[0] is the root
+static uint8_t        depth;
+static uint8_t        dead;
+static expansion_op_t ops[TEXT_EXPANSION_QUEUE_SIZE];
+static uint8_t        ops_head;
+static uint8_t        ops_count;
+static matrix_row_t   swallowed[MATRIX_ROWS]; // presses whose release is dropped too
+
+static uint8_t trie_byte(uint16_t offset) {
+    return pgm_read_byte(&expansion_trie[offset]);
+}
+
+static uint16_t trie_word(uint16_t offset) {
+    return trie_byte(offset) | (uint16_t)trie_byte(offset + 1) << 8;
+}
+
+static uint16_t text_offset(uint16_t node) {
+    return (trie_byte(node) & NODE_TERMINAL) ? trie_word(node + 1) : NO_TEXT;
+}
+
+static uint16_t child(uint16_t node, uint8_t symbol) {
+    uint8_t flags = trie_byte(node);
+    if (!(flags & NODE_CHILDREN)) {
+        return NO_NODE;
+    }
+    uint16_t pos    = node + 1 + ((flags & NODE_TERMINAL) ? 2 : 0);
+    uint32_t bitmap = trie_word(pos) | (uint32_t)trie_word(pos + 2) << 16;
+    uint32_t bit    = (uint32_t)1 << symbol;
+    if (!(bitmap & bit)) {
+        return NO_NODE;
+    }
+    return trie_word(pos + 4 + 2 * __builtin_popcountl(bitmap & (bit - 1)));
+}
+
+/* Trigger symbol of a keycode, in the order of the compiler's ALPHABET, or -1 */
+static int8_t symbol_of(uint16_t keycode) {
+    if (keycode >= KC_A && keycode <= KC_Z) {
+        return keycode - KC_A;
+    }
+    switch (keycode) {
+        case KC_SCLN:
+            return 26;
+        case KC_QUOT:
+            return 27;
+        case KC_COMM:
+            return 28;
+        case KC_DOT:
+            return 29;
+        case KC_SLSH:
+            return 30;
+        case KC_MINS:
+            return 31;
+    }
+    return -1;
+}
+
+/* The basic keycode a press types, KC_NO for holds and keys that type nothing */
+static uint16_t typed_keycode(uint16_t keycode, keyrecord_t *record) {
+    if (IS_QK_MOD_TAP(keycode)) {
+        keycode = record->tap.count > 0 ? mod_tap_get_tap_keycode(keycode) : KC_NO;
+    } else if (IS_QK_LAYER_TAP(keycode)) {
+        keycode = record->tap.count > 0 ? QK_LAYER_TAP_GET_TAP_KEYCODE(keycode) : KC_NO;
+    }
+    return IS_BASIC_KEYCODE(keycode) ? keycode : KC_NO;
+}
+
+static bool queue_op(uint16_t text, uint16_t keycode, uint8_t backspaces) {
+    if (ops_count == TEXT_EXPANSION_QUEUE_SIZE) {
+        return false;
+    }
+    ops[(ops_head + ops_count) & (TEXT_EXPANSION_QUEUE_SIZE - 1)] = (expansion_op_t){text, keycode, backspaces};
+    ops_count++;
+    return true;
+}
+
+/* Advances the match on a typed key; true when it queued an expansion in its place. */
+static bool advance(uint16_t keycode) {
+    uint8_t mods    = get_mods() | get_oneshot_mods();
+    bool    on_base = get_highest_layer(layer_state | default_layer_state) == _DVORAK;
+
+    if (keycode == KC_SPC || keycode == KC_ENT || keycode == KC_TAB) {
+        uint16_t text    = (on_base && !mods && !dead && depth > 0) ? text_offset(path[depth]) : NO_TEXT;
+        uint8_t  trigger = depth;
+        depth            = 0;
+        dead             = 0;
+        return text != NO_TEXT && queue_op(text, keycode, trigger);
+    }
+    if (keycode == KC_BSPC && !(mods & ~MOD_MASK_SHIFT)) {
+        if (dead == DEAD_WORD || (!dead && depth == 0)) {
+            // Back into a word that was never matched.
+            dead = DEAD_WORD;
+        } else if (dead) {
+            dead--;
+        } else {
+            depth--;
+        }
+        return false;
+    }
+    int8_t symbol = symbol_of(keycode);
+    if (symbol < 0 || !on_base || (mods & ~MOD_MASK_SHIFT)) {
+        dead = DEAD_WORD;
+    } else if (dead) {
+        if (dead < DEAD_WORD - 1) {
+            dead++;
+        }
+    } else {
+        uint16_t next = child(path[depth], symbol);
+        if (next == NO_NODE) {
+            dead = 1;
+        } else {
+            path[++depth] = next;
+        }
+    }
+    return false;
+}
+
+static bool output_pending(void) {
+    return ops_count > 0 || !macro_queue_is_empty();
+}
+
+bool process_text_expansion(uint16_t keycode, keyrecord_t *record) {
+    keypos_t     key  = record->event.key;
+    matrix_row_t mask = key.row < MATRIX_ROWS ? (matrix_row_t)1 << key.col : 0;
+
+    if (!record->event.pressed) {
+        if (mask && (swallowed[key.row] & mask)) {
+            swallowed[key.row] &= ~mask;
+            return false;
+        }
+        return true;
+    }
+    keycode = typed_keycode(keycode, record);
+    if (keycode == KC_NO) {
+        return true;
+    }
+    bool pending = output_pending();
+    if (!advance(keycode)) {
+        // Typed ahead of the expansion still draining: keep it behind it.
+        uint16_t tap = (get_mods() & MOD_MASK_SHIFT) ? LSFT(keycode) : keycode;
+        if (!pending || !mask || !queue_op(NO_TEXT, tap, 0)) {
+            return true;
+        }
+    }
+    if (mask) {
+        swallowed[key.row] |= mask;
+    }
+    return false;
+}
+
+void text_expansion_task(void) {
+    while (ops_count > 0) {
+        expansion_op_t *op = &ops[ops_head];
+        for (; op->backspaces > 0; op->backspaces--) {
+            if (!macro_queue_tap16(KC_BSPC)) {
+                return;
+            }
+        }
+        if (op->text != NO_TEXT) {
+            for (uint8_t c; (c = pgm_read_byte(&expansion_text[op->text])) != 0; op->text++) {
+                if (!macro_queue_tap16((c & TEXT_SHIFT) ? LSFT(c & ~TEXT_SHIFT) : c)) {
+                    return;
+                }
+            }
+            op->text = NO_TEXT;
+        }
+        if (!macro_queue_tap16(op->keycode)) {
+            return;
+        }
+        ops_head = (ops_head + 1) & (TEXT_EXPANSION_QUEUE_SIZE - 1);
+        ops_count--;
+    }
+}
@@ -0,0 +1,42 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Text expansion from the dictionary in expansions.txt.
+ *
+ * util/compile_expansions.py compiles the dictionary into expansions_data.h:
+ * a trie of the triggers in PROGMEM whose nodes hold a bitmap of their
+ * children, so each key press on the Dvorak base layer moves the match one
+ * node down with a bit test and a popcount, whatever the size of the
+ * dictionary. Backspace moves it back up. A trigger typed as a whole word
+ * and followed by space, tab or enter is erased and replaced by its text,
+ * then the boundary key is sent.
+ *
+ * The replacement goes out through the macro queue from the housekeeping
+ * task, TEXT_EXPANSION_QUEUE_SIZE expansions deep. Keys typed before it has
+ * drained are queued behind it as taps, so nothing overtakes the text.
+ */
+
+#ifndef EXPANSIONS_DATA_H
+#    define EXPANSIONS_DATA_H "expansions_data.h"
+#endif
+
+bool process_text_expansion(uint16_t keycode, keyrecord_t *record);
+void text_expansion_task(void);
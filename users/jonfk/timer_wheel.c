@@ -0,0 +1,163 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timer_wheel.h"
+
+_Static_assert((TIMER_WHEEL_SLOTS & (TIMER_WHEEL_SLOTS - 1)) == 0, "TIMER_WHEEL_SLOTS must be a power of two");
+_Static_assert(TIMER_WHEEL_POOL_SIZE < UINT8_MAX, "TIMER_WHEEL_POOL_SIZE must fit a uint8_t index");
+
+#define NONE UINT8_MAX
+
+typedef struct {
+    uint32_t               trigger;
+    timer_wheel_callback_t callback;
+    void                  *cb_arg;
+    uint8_t                next;
+    uint8_t                prev;
+    bool                   queued;
+    uint8_t                generation; // tells a stale token from the timer now using the entry
+} timer_entry_t;
+
+static timer_entry_t entries[TIMER_WHEEL_POOL_SIZE];
+static uint8_t       slots[TIMER_WHEEL_SLOTS];
+static uint8_t       free_head;
+static uint32_t      wheel_time; // the slot being run; everything before it has run
+
+static void slot_insert(uint8_t i) {
+    uint8_t *head     = &slots[entries[i].trigger & (TIMER_WHEEL_SLOTS - 1)];
+    entries[i].prev   = NONE;
+    entries[i].next   = *head;
+    entries[i].queued = true;
+    if (*head != NONE) {
+        entries[*head].prev = i;
+    }
+    *head = i;
+}
+
+static void slot_remove(uint8_t i) {
+    timer_entry_t *e = &entries[i];
+    if (e->prev != NONE) {
+        entries[e->prev].next = e->next;
+    } else {
+        slots[e->trigger & (TIMER_WHEEL_SLOTS - 1)] = e->next;
+    }
+    if (e->next != NONE) {
+        entries[e->next].prev = e->prev;
+    }
+    e->queued = false;
+}
+
+static void release(uint8_t i) {
+    entries[i].generation++;
+    entries[i].next = free_head;
+    free_head       = i;
+}
+
+void timer_wheel_init(void) {
+    for (uint8_t i = 0; i < TIMER_WHEEL_POOL_SIZE; i++) {
+        entries[i].queued = false;
+        entries[i].next   = i + 1 < TIMER_WHEEL_POOL_SIZE ? i + 1 : NONE;
+    }
+    for (uint16_t s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+        slots[s] = NONE;
+    }
+    free_head  = 0;
+    wheel_time = timer_read32();
+}
+
+timer_wheel_token_t timer_wheel_schedule(uint32_t delay_ms, timer_wheel_callback_t callback, void *cb_arg) {
+    // As with defer_exec: a slot already run this millisecond would wait a whole turn.
+    if (free_head == NONE || !callback || delay_ms == 0) {
+        return TIMER_WHEEL_INVALID_TOKEN;
+    }
+    uint8_t i = free_head;
+    free_head = entries[i].next;
+
+    entries[i].trigger  = timer_read32() + delay_ms;
+    entries[i].callback = callback;
+    entries[i].cb_arg   = cb_arg;
+    slot_insert(i);
+    return (timer_wheel_token_t)entries[i].generation << 8 | (i + 1);
+}
+
+bool timer_wheel_cancel(timer_wheel_token_t token) {
+    uint8_t i = (token & 0xFF) - 1;
+    if (token == TIMER_WHEEL_INVALID_TOKEN || i >= TIMER_WHEEL_POOL_SIZE || !entries[i].queued || entries[i].generation != token >> 8) {
+        return false;
+    }
+    slot_remove(i);
+    release(i);
+    return true;
+}
+
+/* First timer in the slot that is due now rather than on a later turn */
+static uint8_t first_due(uint8_t slot) {
+    uint8_t i = slots[slot];
+    while (i != NONE && (int32_t)(entries[i].trigger - wheel_time) > 0) {
+        i = entries[i].next;
+    }
+    return i;
+}
+
+/*
+ * Housekeeping does not run during USB suspend, so the wheel can wake hours
+ * behind. With a turn or more to run, every slot is due, and one turn ending
+ * now runs all that came due: a timer's slot comes round at or after its
+ * trigger. A trigger more than 2^31 ms back no longer compares as behind, so
+ * such timers are moved to now first.
+ */
+static void catch_up(uint32_t now, uint32_t behind) {
+    for (uint8_t i = 0; i < TIMER_WHEEL_POOL_SIZE; i++) {
+        uint32_t since = entries[i].trigger - wheel_time;
+        bool     due   = since < behind || (int32_t)since < 0;
+        if (entries[i].queued && due && (int32_t)(now - entries[i].trigger) < 0) {
+            slot_remove(i);
+            entries[i].trigger = now;
+            slot_insert(i);
+        }
+    }
+    wheel_time = now - (TIMER_WHEEL_SLOTS - 1);
+}
+
+void timer_wheel_task(void) {
+    uint32_t now    = timer_read32();
+    uint32_t behind = now + 1 - wheel_time; // slots left to run, up to and including now
+    uint8_t  budget = TIMER_WHEEL_MAX_CALLBACKS;
+
+    if (behind > TIMER_WHEEL_SLOTS) {
+        catch_up(now, behind);
+    }
+    while ((int32_t)(now - wheel_time) >= 0) {
+        uint8_t slot = wheel_time & (TIMER_WHEEL_SLOTS - 1);
+        uint8_t i;
+        // Callbacks may schedule or cancel anything, so look the slot up again after each one.
+        while ((i = first_due(slot)) != NONE) {
+            if (budget-- == 0) {
+                return;
+            }
+            slot_remove(i);
+            uint32_t delay = entries[i].callback(entries[i].trigger, entries[i].cb_arg);
+            if (delay) {
+                uint32_t trigger   = entries[i].trigger + delay;
+                entries[i].trigger = (int32_t)(trigger - wheel_time) > 0 ? trigger : wheel_time + 1;
+                slot_insert(i);
+            } else {
+                release(i);
+            }
+        }
+        wheel_time++;
+    }
+}
@@ -0,0 +1,49 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Deferred callbacks on a hashed timer wheel.
+ *
+ * A drop-in for defer_exec/cancel_deferred_exec when many timers are pending
+ * at once. Timers come from a preallocated pool and hang off one of
+ * TIMER_WHEEL_SLOTS one-millisecond slots, chosen by trigger time modulo the
+ * slot count, in doubly linked lists. Scheduling and cancelling are O(1), and
+ * each millisecond only looks at the timers in its own slot. Timers further
+ * away than one turn of the wheel are skipped until their turn comes round.
+ * At most TIMER_WHEEL_MAX_CALLBACKS callbacks run per housekeeping pass; the
+ * rest run on the next pass, so a burst of expiries cannot stall a scan.
+ *
+ * As with defer_exec, a callback returns 0 to finish or a delay in ms to run
+ * again, counted from its previous trigger time.
+ */
+
+typedef uint16_t timer_wheel_token_t;
+typedef uint32_t (*timer_wheel_callback_t)(uint32_t trigger_time, void *cb_arg);
+
+#define TIMER_WHEEL_INVALID_TOKEN 0
+
+void timer_wheel_init(void);
+void timer_wheel_task(void);
+
+/* Returns TIMER_WHEEL_INVALID_TOKEN for a delay of 0 or when the pool is exhausted */
+timer_wheel_token_t timer_wheel_schedule(uint32_t delay_ms, timer_wheel_callback_t callback, void *cb_arg);
+
+/* False if the timer already ran or was cancelled */
+bool timer_wheel_cancel(timer_wheel_token_t token);
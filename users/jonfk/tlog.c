@@ -0,0 +1,95 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tlog.h"
+
+_Static_assert((TLOG_BUFFER_SIZE & (TLOG_BUFFER_SIZE - 1)) == 0, "TLOG_BUFFER_SIZE must be a power of two");
+
+// A record in the buffer is its length, the token and the varints; the
+// length lets the drain send whole records only, so a console report that
+// goes out half full never splits one.
+#define RECORD_MAX (2 + 5 * TLOG_MAX_ARGS)
+
+static uint8_t  buffer[TLOG_BUFFER_SIZE];
+static uint16_t head; // free running, masked on access
+static uint16_t tail;
+static uint16_t dropped;
+
+static uint8_t encode(uint8_t *record, uint8_t token, const uint32_t *args, uint8_t count) {
+    uint8_t n   = 1;
+    record[n++] = token;
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t v = args[i];
+        while (v >= 0x80) {
+            record[n++] = (uint8_t)v | 0x80;
+            v >>= 7;
+        }
+        record[n++] = (uint8_t)v;
+    }
+    record[0] = n - 1;
+    return n;
+}
+
+static bool push(const uint8_t *record, uint8_t n) {
+    if (TLOG_BUFFER_SIZE - (uint16_t)(head - tail) < n) {
+        return false;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        buffer[head++ & (TLOG_BUFFER_SIZE - 1)] = record[i];
+    }
+    return true;
+}
+
+void tlog_write(uint8_t token, const uint32_t *args, uint8_t count) {
+    uint8_t record[RECORD_MAX];
+
+    if (dropped) {
+        uint32_t lost = dropped;
+        if (!push(record, encode(record, TLOG_DROPPED, &lost, 1))) {
+            dropped++;
+            return;
+        }
+        dropped = 0;
+    }
+    // More arguments than the format can be checked against are dropped
+    // whole rather than sent short.
+    if (count > TLOG_MAX_ARGS || !push(record, encode(record, token, args, count))) {
+        dropped++;
+    }
+}
+
+void tlog_init(void) {
+    TLOG(BOOT, TLOG_TOKEN_COUNT);
+}
+
+void tlog_task(void) {
+    if (head == tail || last_matrix_activity_elapsed() < TLOG_IDLE_MS) {
+        return;
+    }
+    uint8_t sent = 0;
+    while (head != tail) {
+        uint8_t n = buffer[tail & (TLOG_BUFFER_SIZE - 1)];
+        if (sent && sent + 1 + n > TLOG_DRAIN_BYTES) {
+            break;
+        }
+        tail++;
+        sendchar(TLOG_SYNC);
+        for (uint8_t i = 0; i < n; i++) {
+            sendchar(buffer[tail++ & (TLOG_BUFFER_SIZE - 1)]);
+        }
+        sent += 1 + n;
+    }
+}
@@ -0,0 +1,59 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Tokenized logging.
+ *
+ * print() keeps every format string in flash and pushes the formatted text
+ * through the HID console from wherever it is called, key processing
+ * included. TLOG(NAME, args...) instead appends the message's token number
+ * and its arguments as varints to a RAM ring buffer, a few bytes per
+ * message. The housekeeping task sends the records to the console once the
+ * matrix has been idle for TLOG_IDLE_MS, and util/tlog.py turns them back
+ * into text with the formats in tlog_tokens.h, which never reach the
+ * firmware.
+ *
+ * On the wire each record is TLOG_SYNC, the token, then one varint per
+ * argument; signed arguments go as their 32-bit two's complement. Without
+ * TLOG_ENABLE, TLOG() compiles to nothing.
+ */
+
+enum tlog_tokens {
+#define TLOG_TOKEN(name, format) TLOG_##name,
+#include "tlog_tokens.h"
+#undef TLOG_TOKEN
+    TLOG_TOKEN_COUNT,
+};
+
+_Static_assert(TLOG_TOKEN_COUNT <= 256, "Log tokens must fit in a byte");
+
+#define TLOG_SYNC 0x1E
+#define TLOG_MAX_ARGS 4
+
+#ifdef TLOG_ENABLE
+#    define TLOG_ARGS(...) ((const uint32_t[]){0, ##__VA_ARGS__})
+#    define TLOG(name, ...) tlog_write(TLOG_##name, TLOG_ARGS(__VA_ARGS__) + 1, sizeof(TLOG_ARGS(__VA_ARGS__)) / sizeof(uint32_t) - 1)
+
+void tlog_init(void);
+void tlog_task(void);
+void tlog_write(uint8_t token, const uint32_t *args, uint8_t count);
+#else
+#    define TLOG(name, ...) ((void)0)
+#endif
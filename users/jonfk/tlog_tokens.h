@@ -0,0 +1,32 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Log messages, one per line as TLOG_TOKEN(name, "format"). The firmware only
+ * keeps the names, numbered in the order below; util/tlog.py reads the
+ * formats from this file to decode the log. Add messages at the end so older
+ * logs still decode. Formats take %u, %d, %x and %c, one per argument, and at
+ * most TLOG_MAX_ARGS arguments.
+ */
+
+// clang-format off
+TLOG_TOKEN(BOOT,          "log started, %u messages known")
+TLOG_TOKEN(DROPPED,       "%u messages dropped, log buffer full")
+TLOG_TOKEN(DEFAULT_LAYER, "default layer switched to %u")
+TLOG_TOKEN(TAPPING_TERM,  "tapping term at %u,%u learned as %u ms")
+TLOG_TOKEN(SCAN_IDLE,     "scan idle, %u scans/s while active")
+TLOG_TOKEN(SCAN_WAKE,     "scan woke after %u ms idle, key seen within %u us, %u scans/s while idle")
+// clang-format on
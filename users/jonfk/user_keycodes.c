@@ -0,0 +1,142 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jonfk.h"
+
+/*
+ * Userspace keycodes are dispatched through a const table indexed by
+ * keycode - SAFE_RANGE: one bounds check and an indirect call, however many
+ * keycodes there are. Entries left empty fall through to the keymap.
+ */
+
+typedef bool (*keycode_handler_t)(uint16_t arg, keyrecord_t *record);
+
+typedef struct {
+    keycode_handler_t handler;
+    uint16_t          arg;
+} keycode_action_t;
+
+static bool set_default_layer(uint16_t layer, keyrecord_t *record) {
+    if (record->event.pressed) {
+        settings_set_default_layer(layer);
+#ifdef TLOG_ENABLE
+        TLOG(DEFAULT_LAYER, layer);
+#else
+        if (layer == _QWERTY) {
+            print("mode just switched to qwerty and this is a huge string\n");
+        }
+#endif
+    }
+    return false;
+}
+
+// Built-in macros, by slot; the host can replace them with HID_COMMAND_ENABLE.
+static const uint16_t builtin_macros[USER_MACRO_COUNT] = {
+    [MA_WI_COPY - MA_WI_COPY] = LCTL(KC_C),
+    [MA_WI_CUT - MA_WI_COPY]  = LCTL(KC_X),
+    [MA_WI_PSTE - MA_WI_COPY] = LCTL(KC_V),
+};
+
+static bool play_macro(uint16_t slot, keyrecord_t *record) {
+    if (!record->event.pressed) {
+        return false;
+    }
+#ifdef HID_COMMAND_ENABLE
+    if (hid_command_play_macro(slot)) {
+        return false;
+    }
+#endif
+    macro_queue_tap16(builtin_macros[slot]);
+    return false;
+}
+
+#ifdef ENCODER_SCROLL_ENABLE
+static bool scroll(uint16_t keycode, keyrecord_t *record) {
+    return process_encoder_scroll(keycode, record);
+}
+#endif
+
+#ifdef ENCODER_NOTES_ENABLE
+static bool notes(uint16_t keycode, keyrecord_t *record) {
+    return process_encoder_notes(keycode, record);
+}
+#endif
+
+// clang-format off
+static const keycode_action_t keycode_actions[USER_SAFE_RANGE - SAFE_RANGE] = {
+#ifdef ENCODER_SCROLL_ENABLE
+    [SCRL_UP    - SAFE_RANGE] = {scroll, SCRL_UP},
+    [SCRL_DN    - SAFE_RANGE] = {scroll, SCRL_DN},
+#endif
+#ifdef ENCODER_NOTES_ENABLE
+    [NOTE_UP    - SAFE_RANGE] = {notes, NOTE_UP},
+    [NOTE_DN    - SAFE_RANGE] = {notes, NOTE_DN},
+    [NOTE_TG    - SAFE_RANGE] = {notes, NOTE_TG},
+#endif
+    [QWERTY     - SAFE_RANGE] = {set_default_layer, _QWERTY},
+    [DVORAK     - SAFE_RANGE] = {set_default_layer, _DVORAK},
+    [MA_WI_COPY - SAFE_RANGE] = {play_macro, MA_WI_COPY - MA_WI_COPY},
+    [MA_WI_CUT  - SAFE_RANGE] = {play_macro, MA_WI_CUT - MA_WI_COPY},
+    [MA_WI_PSTE - SAFE_RANGE] = {play_macro, MA_WI_PSTE - MA_WI_COPY},
+};
+// clang-format on
+
+static const uint16_t mod_tap16_keycodes[MOD_TAP16_COUNT] = {
+    [MT16_TILD] = KC_TILD,
+    [MT16_DQUO] = KC_DQUO,
+};
+
+uint16_t mod_tap_get_tap_keycode(uint16_t keycode) {
+    uint8_t tap = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    if (tap >= MT16_BASE && tap < MT16_BASE + MOD_TAP16_COUNT) {
+        return mod_tap16_keycodes[tap - MT16_BASE];
+    }
+    return tap;
+}
+
+/*
+ * A tapped MT16 key goes out the way a plain KC_TILD key would, shift and key
+ * in one report, and comes back up in one report too; tap_code16 would send
+ * four.
+ */
+static bool process_mod_tap16(uint16_t tap, keyrecord_t *record) {
+    uint8_t mods = QK_MODS_GET_MODS(tap);
+    mods         = (mods & 0x10) ? (uint8_t)((mods & 0x0F) << 4) : mods;
+    if (record->event.pressed) {
+        add_weak_mods(mods);
+        register_code(QK_MODS_GET_BASIC_KEYCODE(tap));
+    } else {
+        del_weak_mods(mods);
+        unregister_code(QK_MODS_GET_BASIC_KEYCODE(tap));
+    }
+    return false;
+}
+
+bool process_user_keycode(uint16_t keycode, keyrecord_t *record) {
+    if (IS_QK_MOD_TAP(keycode) && record->tap.count > 0) {
+        uint16_t tap = mod_tap_get_tap_keycode(keycode);
+        if (IS_QK_MODS(tap)) {
+            return process_mod_tap16(tap, record);
+        }
+        return true;
+    }
+
+    if (keycode < SAFE_RANGE || keycode >= USER_SAFE_RANGE) {
+        return true;
+    }
+    const keycode_action_t *action = &keycode_actions[keycode - SAFE_RANGE];
+    return action->handler ? action->handler(action->arg, record) : true;
+}
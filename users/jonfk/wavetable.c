@@ -0,0 +1,177 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <hal.h>
+
+#include "jonfk.h"
+#include "audio_dac.h"
+#include "hid_bytes.h"
+#include "raw_hid.h"
+
+#define WAVETABLE_VOICES AUDIO_MAX_SIMULTANEOUS_TONES
+#define TABLE_BITS 8
+
+/* Each voice gets an equal share of the swing either side of mid-scale, so a full chord cannot clip */
+#define DAC_MID (AUDIO_DAC_SAMPLE_MAX / 2)
+#define VOICE_AMPLITUDE ((int32_t)DAC_MID / WAVETABLE_VOICES)
+
+/* One turn of the phase accumulator is 2^32 */
+#define PHASE_PER_HZ (4294967296.0f / AUDIO_DAC_SAMPLE_RATE)
+
+#define STATS_SIZE 10
+
+_Static_assert(8 + 2 * STATS_SIZE <= 32, "scan rate stats do not fit a raw HID packet");
+
+// round(32767 * sin(2 * pi * i / 256))
+// clang-format off
+static const int16_t PROGMEM sine[1 << TABLE_BITS] = {
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+     12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,  18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+     23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,  27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+     30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+     32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,  32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+     30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,  27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+     23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+     12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,   6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+         0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683, -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,  -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+};
+// clang-format on
+
+static volatile uint32_t increment[WAVETABLE_VOICES]; // written by wavetable_task, 0 when silent
+static uint32_t          phase[WAVETABLE_VOICES];     // owned by the DAC interrupt
+static volatile uint16_t quiet_samples;               // mid-scale samples in a row, counted by the interrupt
+
+enum { SILENT, PLAYING };
+
+static wavetable_scan_rate_t rates[2];
+static uint32_t              window_start;
+static uint32_t              window_scans;
+static bool                  window_mixed;
+static bool                  window_playing;
+
+uint16_t dac_value_generate(void) {
+    int32_t  sum      = 0;
+    uint32_t sounding = 0;
+    for (uint8_t v = 0; v < WAVETABLE_VOICES; v++) {
+        uint32_t inc = increment[v];
+        // A silent voice goes back to phase 0, where the table is 0, instead of holding an
+        // offset; masked rather than branched so every voice takes the same path.
+        phase[v] = (phase[v] + inc) & -(uint32_t)(inc != 0);
+        sum += (int16_t)pgm_read_word(&sine[phase[v] >> (32 - TABLE_BITS)]);
+        sounding |= inc;
+    }
+    quiet_samples = sounding ? 0 : quiet_samples + (quiet_samples < UINT16_MAX);
+    return (uint16_t)(DAC_MID + ((sum * VOICE_AMPLITUDE) >> 15));
+}
+
+static void update_voices(void) {
+    uint8_t tones = audio_get_number_of_active_tones();
+    for (uint8_t v = 0; v < WAVETABLE_VOICES; v++) {
+        increment[v] = v < tones ? (uint32_t)(audio_get_processed_frequency(v) * PHASE_PER_HZ) : 0;
+    }
+}
+
+/*
+ * The driver's own dac_value_generate is where its output state machine
+ * waits for a zero crossing before it stops the timer, and that state is
+ * private to the driver. With this generator in its place the driver never
+ * stops, so the timer and the DMA interrupt would run at the sample rate
+ * from the startup song on. Instead the timer is stopped here once a whole
+ * DMA buffer of mid-scale samples has gone out, which the DAC then holds, and
+ * started again through the driver for the next tone. A melody keeps it
+ * running through its rests, since the interrupt is what moves it on.
+ */
+static void pace_dac(bool playing) {
+    bool running = WAVETABLE_DAC_TIMER.state == GPT_CONTINUOUS;
+    if (playing) {
+        // Silence from before this tone does not count towards stopping after it.
+        quiet_samples = 0;
+        if (!running) {
+            audio_driver_start();
+        }
+    } else if (running && quiet_samples >= AUDIO_DAC_BUFFER_SIZE) {
+        gptStopTimer(&WAVETABLE_DAC_TIMER);
+    }
+}
+
+static void count_scan(bool playing) {
+    uint32_t elapsed = timer_elapsed32(window_start);
+    if (window_scans && elapsed >= WAVETABLE_RATE_WINDOW_MS) {
+        // Windows where audio started or stopped part way tell nothing either way.
+        if (!window_mixed) {
+            wavetable_scan_rate_t *r    = &rates[window_playing ? PLAYING : SILENT];
+            uint32_t               rate = window_scans * 1000 / elapsed;
+
+            r->last = rate;
+            r->min  = r->windows ? MIN(r->min, rate) : rate;
+            if (r->windows < UINT16_MAX) {
+                r->windows++;
+            }
+        }
+        window_scans = 0;
+    }
+    if (window_scans == 0) {
+        window_start   = timer_read32();
+        window_playing = playing;
+        window_mixed   = false;
+    }
+    window_scans++;
+    window_mixed |= playing != window_playing;
+}
+
+void wavetable_task(void) {
+    update_voices();
+    bool tones = audio_get_number_of_active_tones() > 0;
+    pace_dac(tones || audio_is_playing_melody());
+    count_scan(tones);
+}
+
+bool wavetable_raw_hid_receive(uint8_t *data, uint8_t length) {
+    if (length < 2 || data[0] != WAVETABLE_HID_ID) {
+        return false;
+    }
+    uint8_t command = data[1];
+    memset(data + 1, 0, length - 1);
+
+    switch (command) {
+        case WAVETABLE_HID_INFO: {
+            put_u32(&data[1], AUDIO_DAC_SAMPLE_RATE);
+            data[5] = WAVETABLE_VOICES;
+            put_u16(&data[6], WAVETABLE_RATE_WINDOW_MS);
+            uint8_t *p = &data[8];
+            for (uint8_t i = SILENT; i <= PLAYING; i++, p += STATS_SIZE) {
+                put_u32(p, rates[i].last);
+                put_u32(p + 4, rates[i].min);
+                put_u16(p + 8, rates[i].windows);
+            }
+            break;
+        }
+        case WAVETABLE_HID_CLEAR:
+            memset(rates, 0, sizeof(rates));
+            window_scans = 0;
+            break;
+    }
+    raw_hid_send(data, length);
+    return true;
+}
@@ -0,0 +1,58 @@
+/* Copyright 2024 jonfk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+/*
+ * Wavetable sample generator for the DAC additive audio driver, and a scan
+ * rate meter to see what audio costs the matrix scan.
+ *
+ * The driver fills its DMA buffer half at a time from its interrupt, one
+ * dac_value_generate() call per sample. This one mixes a fixed
+ * WAVETABLE_VOICES voices from a precomputed sine table with 32-bit phase
+ * accumulators: per sample, every voice costs one add and one table read
+ * whether it is sounding or not, so the interrupt takes the same time for
+ * a click, a song or a chord and there is no float math in it. The phase
+ * increments are worked out from the audio core's tones in
+ * wavetable_task(), on the main loop, which also stops the DAC timer once
+ * the output has gone silent and starts it again for the next tone.
+ *
+ * The meter counts housekeeping passes, one per matrix scan, over windows
+ * of WAVETABLE_RATE_WINDOW_MS, and keeps windows with audio playing
+ * throughout apart from silent ones. util/scan_rate.py reads them with
+ * WAVETABLE_HID_ID requests.
+ */
+
+/* Raw HID packets starting with this byte belong to the scan rate meter. */
+#define WAVETABLE_HID_ID 0x57
+
+enum wavetable_hid_command {
+    WAVETABLE_HID_INFO  = 0, // reply: sample rate (u32), voices (u8), window ms (u16), then silent and playing stats
+    WAVETABLE_HID_CLEAR = 1,
+};
+
+/* Scans per second over the windows of one kind, sent to the host in this order, little-endian. */
+typedef struct {
+    uint32_t last;
+    uint32_t min;
+    uint16_t windows;
+} wavetable_scan_rate_t;
+
+void     wavetable_task(void);
+uint16_t dac_value_generate(void);
+bool     wavetable_raw_hid_receive(uint8_t *data, uint8_t length);
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+# Copyright 2024 jonfk
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Compile the text expansion dictionary into the PROGMEM trie of text_expansion.c.
+
+    util/compile_expansions.py                  # users/jonfk/expansions.txt -> expansions_data.h
+    util/compile_expansions.py --check          # exit 1 if expansions_data.h is out of date
+    util/compile_expansions.py --synthetic 2048 -o build/expansions_2048.h
+
+The trie is stored as nodes of
+
+    flags (u8)            0x80 a trigger ends here, 0x40 the node has children
+    text offset (u16)     with 0x80: the expansion in expansion_text
+    child bitmap (u32)    with 0x40: bit n set when symbol n has a child
+    child offsets (u16)   with 0x40: one per set bit, in symbol order
+
+with identical subtrees stored once, so triggers that end alike share their
+tails. The expansion texts are keycode strings, a byte per character with
+0x80 for shift and a 0 at the end, and a text that is the tail of another
+points into it. Multi-byte values are little-endian.
+"""
+
+import argparse
+import os
+import random
+import sys
+
+USERSPACE = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+DICTIONARY = os.path.join(USERSPACE, "users", "jonfk", "expansions.txt")
+HEADER = os.path.join(USERSPACE, "users", "jonfk", "expansions_data.h")
+
+# Trigger symbols, in bit order; text_expansion.c maps keycodes to the same.
+ALPHABET = "abcdefghijklmnopqrstuvwxyz;',./-"
+assert len(ALPHABET) == 32
+
+TERMINAL, CHILDREN = 0x80, 0x40
+SHIFT = 0x80
+
+# US ANSI: character -> (basic keycode, shifted)
+KEYCODES = {c: (0x04 + i, False) for i, c in enumerate("abcdefghijklmnopqrstuvwxyz")}
+KEYCODES.update({c: (0x04 + i, True) for i, c in enumerate("ABCDEFGHIJKLMNOPQRSTUVWXYZ")})
+KEYCODES.update({c: (0x1E + i, False) for i, c in enumerate("1234567890")})
+KEYCODES.update({c: (0x1E + i, True) for i, c in enumerate("!@#$%^&*()")})
+for plain, shifted, code in zip(" -=[]\;'`,./", " _+{}|:\"~<>?", [0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38]):
+    KEYCODES[plain] = (code, False)
+    if shifted != " ":
+        KEYCODES[shifted] = (code, True)
+
+
+def parse(lines, source):
+    entries = {}
+    for lineno, line in enumerate(lines, 1):
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        parts = line.split(None, 1)
+        if len(parts) != 2:
+            sys.exit(f"{source}:{lineno}: expected '<trigger> <text>'")
+        trigger, text = parts[0].lower(), parts[1]
+        if any(c not in ALPHABET for c in trigger):
+            sys.exit(f"{source}:{lineno}: trigger characters must be one of {ALPHABET}")
+        if any(c not in KEYCODES for c in text):
+            sys.exit(f"{source}:{lineno}: text must be printable ASCII")
+        if trigger in entries:
+            sys.exit(f"{source}:{lineno}: duplicate trigger {trigger}")
+        entries[trigger] = text
+    if not entries:
+        sys.exit(f"{source}: no expansions")
+    return entries
+
+
+def synthetic(count, seed):
+    """count random triggers of 2-6 symbols, each expanding to a few made-up words."""
+    rng = random.Random(seed)
+    letters = "abcdefghijklmnopqrstuvwxyz"
+    words = ["".join(rng.choice(letters) for _ in range(rng.randint(2, 8))) for _ in range(512)]
+    entries = {}
+    while len(entries) < count:
+        trigger = "".join(rng.choice(letters) for _ in range(rng.randint(2, 6)))
+        entries.setdefault(trigger, " ".join(rng.choice(words) for _ in range(rng.randint(1, 4))))
+    return entries
+
+
+def encode_texts(entries):
+    """(blob, {text: offset}) with every text that is a tail of a longer one stored inside it."""
+    encoded = {}
+    for text in set(entries.values()):
+        out = bytearray()
+        for c in text:
+            code, shifted = KEYCODES[c]
+            out.append(code | (SHIFT if shifted else 0))
+        encoded[text] = bytes(out)
+    blob, offsets, placed = bytearray(), {}, []
+    for text in sorted(encoded, key=lambda t: (-len(encoded[t]), t)):
+        data = encoded[text]
+        for start, stored in placed:
+            if stored.endswith(data):
+                offsets[text] = start + len(stored) - len(data)
+                break
+        else:
+            offsets[text] = len(blob)
+            placed.append((len(blob), data))
+            blob += data + b"\0"
+    return bytes(blob), offsets
+
+
+def build_trie(entries, text_offsets):
+    """(trie bytes, node count before sharing, node count stored)."""
+    root = {}
+    for trigger, text in entries.items():
+        node = root
+        for c in trigger:
+            node = node.setdefault(ALPHABET.index(c), {})
+        node[None] = text_offsets[text]
+
+    trie = bytearray()
+    shared = {}
+    counts = [0]
+
+    def emit(node):
+        counts[0] += 1
+        children = sorted((s, emit(child)) for s, child in node.items() if s is not None)
+        key = (node.get(None), tuple(children))
+        if key in shared:
+            return shared[key]
+        flags = (TERMINAL if None in node else 0) | (CHILDREN if children else 0)
+        out = bytearray([flags])
+        if None in node:
+            out += node[None].to_bytes(2, "little")
+        if children:
+            out += sum(1 << s for s, _ in children).to_bytes(4, "little")
+            for _, offset in children:
+                out += offset.to_bytes(2, "little")
+        shared[key] = len(trie)
+        trie.extend(out)
+        return shared[key]
+
+    # Children are emitted before their parent, so the root goes last; it is
+    # moved to the front by storing it again there and rebasing every offset.
+    root_offset = emit(root)
+    root_bytes = trie[root_offset:]
+    del trie[root_offset:]
+    trie = rebase(bytes(root_bytes), len(root_bytes)) + rebase(bytes(trie), len(root_bytes))
+    if len(trie) > 0xFFFF:
+        sys.exit(f"trie of {len(trie)} bytes does not fit 16-bit offsets")
+    return trie, counts[0], len(shared)
+
+
+def rebase(nodes, shift):
+    """Adds shift to every child offset in a run of serialized nodes."""
+    out = bytearray(nodes)
+    pos = 0
+    while pos < len(out):
+        flags = out[pos]
+        pos += 1 + (2 if flags & TERMINAL else 0)
+        if flags & CHILDREN:
+            bitmap = int.from_bytes(out[pos : pos + 4], "little")
+            pos += 4
+            for _ in range(bin(bitmap).count("1")):
+                offset = int.from_bytes(out[pos : pos + 2], "little") + shift
+                out[pos : pos + 2] = offset.to_bytes(2, "little")
+                pos += 2
+    return bytes(out)
+
+
+def c_array(name, data):
+    lines = [f"static const uint8_t PROGMEM {name}[] = {{"]
+    for i in range(0, len(data), 16):
+        lines.append("    " + " ".join(f"0x{b:02X}," for b in data[i : i + 16]))
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def render(entries, source):
+    texts, offsets = encode_texts(entries)
+    if len(texts) > 0xFFFF:
+        sys.exit(f"expansion text of {len(texts)} bytes does not fit 16-bit offsets")
+    trie, nodes, stored = build_trie(entries, offsets)
+    header = f"""// Generated by util/compile_expansions.py from {source}, do not edit.
+// {len(entries)} expansions, {nodes} trie nodes stored as {stored}: {len(trie)} + {len(texts)} bytes
+
+#pragma once
+
+#define EXPANSION_COUNT {len(entries)}
+#define EXPANSION_MAX_TRIGGER {max(len(t) for t in entries)}
+
+// clang-format off
+{c_array("expansion_trie", trie)}
+
+{c_array("expansion_text", texts)}
+// clang-format on
+"""
+    return header, len(trie), len(texts), nodes, stored
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dictionary", nargs="?", default=DICTIONARY)
+    parser.add_argument("-o", "--output", default=HEADER)
+    parser.add_argument("--check", action="store_true", help="only check that the output is up to date")
+    parser.add_argument("--synthetic", type=int, metavar="N", help="compile N random expansions instead of the dictionary")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    if args.synthetic:
+        entries, source = synthetic(args.synthetic, args.seed), f"{args.synthetic} synthetic expansions"
+    else:
+        with open(args.dictionary) as f:
+            entries = parse(f, args.dictionary)
+        source = os.path.basename(args.dictionary)
+    header, trie_size, text_size, nodes, stored = render(entries, source)
+
+    if args.check:
+        try:
+            with open(args.output) as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != header:
+            sys.exit(f"{args.output} is out of date, run util/compile_expansions.py")
+        return
+    with open(args.output, "w") as f:
+        f.write(header)
+    print(f"{len(entries)} expansions: trie {trie_size} bytes ({stored} of {nodes} nodes), text {text_size} bytes")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+# Copyright 2024 jonfk
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Decode GeminiPR steno packets into Plover-style strokes.
+
+    util/geminipr.py /dev/ttyACM0                    # read the Planck's virtual serial port
+    sim/build/sim_planck sim/traces/planck_plover.trace | util/geminipr.py -
+    sim/build/sim_planck sim/traces/planck_plover.trace | util/geminipr.py - --expect KAT STPH
+
+Reading a serial port requires the `pyserial` package. With `-`, the
+`steno` lines printed by the simulator are decoded from stdin. With
+`--expect`, the decoded strokes are compared with the given ones and the
+exit status is 1 when they differ.
+"""
+
+import argparse
+import sys
+
+PACKET_SIZE = 6
+
+# Key names in packet bit order, seven per byte, most significant bit first.
+# fmt: off
+KEYS = [
+    "Fn", "#", "#", "#", "#", "#", "#",
+    "S-", "S-", "T-", "K-", "P-", "W-", "H-",
+    "R-", "A-", "O-", "*", "*", "res1", "res2",
+    "pwr", "*", "*", "-E", "-U", "-F", "-R",
+    "-P", "-B", "-L", "-G", "-T", "-S", "-D",
+    "#", "#", "#", "#", "#", "#", "-Z",
+]
+# fmt: on
+
+STENO_ORDER = ["#", "S-", "T-", "K-", "P-", "W-", "H-", "R-", "A-", "O-", "*", "-E", "-U", "-F", "-R", "-P", "-B", "-L", "-G", "-T", "-S", "-D", "-Z"]
+MIDDLE = {"A-", "O-", "*", "-E", "-U"}
+
+
+def decode(packet):
+    """Return the stroke in steno order, e.g. 'KAT' or 'STPH' or '-D'."""
+    if len(packet) != PACKET_SIZE or not packet[0] & 0x80 or any(b & 0x80 for b in packet[1:]):
+        raise ValueError(f"not a GeminiPR packet: {packet.hex()}")
+    pressed = set()
+    for i, name in enumerate(KEYS):
+        if packet[i // 7] & (0x40 >> (i % 7)):
+            pressed.add(name)
+
+    stroke = ""
+    needs_hyphen = not pressed & MIDDLE
+    for key in STENO_ORDER:
+        if key not in pressed:
+            continue
+        if key.startswith("-") and needs_hyphen:
+            stroke += "-"
+            needs_hyphen = False
+        stroke += key.strip("-")
+    return stroke
+
+
+def packets_from_serial(path):
+    import serial
+
+    with serial.Serial(path, 9600) as port:
+        buffer = bytearray()
+        while True:
+            buffer += port.read(1)
+            # Resynchronise on the start bit of the first byte.
+            while buffer and not buffer[0] & 0x80:
+                buffer.pop(0)
+            if len(buffer) >= PACKET_SIZE:
+                yield bytes(buffer[:PACKET_SIZE])
+                del buffer[:PACKET_SIZE]
+
+
+def packets_from_sim(lines):
+    for line in lines:
+        fields = line.split()
+        if len(fields) == 2 + PACKET_SIZE and fields[1] == "steno":
+            yield bytes(int(b, 16) for b in fields[2:])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="serial port, or - for the simulator's output on stdin")
+    parser.add_argument("--expect", nargs="+", metavar="STROKE", help="fail unless exactly these strokes are decoded")
+    args = parser.parse_args()
+
+    source = packets_from_sim(sys.stdin) if args.port == "-" else packets_from_serial(args.port)
+    strokes = []
+    for packet in source:
+        strokes.append(decode(packet))
+        print(f"{packet.hex(' ')}  {strokes[-1]}", flush=True)
+    if args.expect is not None and strokes != args.expect:
+        sys.exit(f"strokes {' '.join(strokes) or '(none)'}, expected {' '.join(args.expect)}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+# Copyright 2024 jonfk
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Read the jonfk key usage heatmap over raw HID and draw it on the board layout.
+
+Build the keymap with HEATMAP_ENABLE = yes (on for both boards), type for a while, then run
+
+    util/heatmap.py                          # board taken from the USB product name
+    util/heatmap.py --board unicorne -l 0 -l 2
+    util/heatmap.py --dump out.bin           # also keep the raw table
+    util/heatmap.py --load out.bin --board planck
+    sim/build/sim_planck -q -H out.bin sim/traces/planck_dvorak.trace
+
+Requires the `hid` package (hidapi) unless --load is used.
+"""
+
+import argparse
+import struct
+import sys
+
+RAW_USAGE_PAGE = 0xFF60
+RAW_USAGE = 0x61
+PACKET_SIZE = 32
+
+HEATMAP_HID_ID = 0x48
+CMD_INFO, CMD_READ, CMD_CLEAR = 0, 1, 2
+HEATMAP_VERSION = 1
+NO_KEY = 0xFF
+
+INFO = struct.Struct("<BBBBBHHI")  # version, rows, cols, layers, mod-taps, size, gap average, presses
+
+SHADES = " .:-=+*#%@"
+
+
+def planck_grid():
+    """(row, col) in the matrix for each key, by visual row; None for gaps."""
+    return [[(r if c < 6 else r + 4, c % 6) for c in range(12)] for r in range(4)]
+
+
+def unicorne_grid():
+    rows = [[(r, c) for c in range(6)] + [None] + [(r + 4, c) for c in range(6)] for r in range(3)]
+    rows.append([None, None, None] + [(3, c) for c in range(3, 6)] + [None] + [(7, c) for c in range(3)] + [None, None, None])
+    return rows
+
+
+# Layer names follow the keymaps' layer enums; the first two are userspace's.
+BOARDS = {
+    "planck": (planck_grid(), ["DVORAK", "QWERTY", "COLEMAK", "LOWER", "RAISE", "PLOVER", "ADJUST", "NAV"]),
+    "unicorne": (unicorne_grid(), ["DVORAK", "QWERTY", "SYM", "NUM", "ADJUST", "NAV"]),
+}
+
+
+def open_keyboard():
+    import hid
+
+    for info in hid.enumerate():
+        if info["usage_page"] == RAW_USAGE_PAGE and info["usage"] == RAW_USAGE:
+            dev = hid.device()
+            dev.open_path(info["path"])
+            return dev, info.get("product_string") or ""
+    sys.exit("no raw HID interface found")
+
+
+def request(dev, command, offset=0):
+    # Leading zero is the report ID expected by hidapi.
+    packet = bytes([0, HEATMAP_HID_ID, command]) + struct.pack("<H", offset) + bytes(PACKET_SIZE - 4)
+    dev.write(packet)
+    reply = bytes(dev.read(PACKET_SIZE, 1000))
+    if len(reply) < PACKET_SIZE or reply[0] != HEATMAP_HID_ID:
+        sys.exit("unexpected reply from keyboard")
+    return reply
+
+
+def read_table(dev):
+    info = request(dev, CMD_INFO)
+    size = INFO.unpack_from(info, 1)[5]
+    table = bytearray()
+    while len(table) < size:
+        reply = request(dev, CMD_READ, len(table))
+        if reply[1] == 0:
+            sys.exit("keyboard stopped sending the table")
+        table += reply[2 : 2 + reply[1]]
+    return info, bytes(table)
+
+
+def parse(info, table):
+    version, rows, cols, layers, mod_taps, size, gap_average, presses = INFO.unpack_from(info, 1)
+    if version != HEATMAP_VERSION:
+        sys.exit(f"heatmap version {version}, this script reads {HEATMAP_VERSION}")
+    keys = rows * cols
+    counts = struct.unpack_from(f"<{layers * keys}H", table, 4)
+    offset = 4 + 2 * layers * keys
+    slots = table[offset : offset + mod_taps]
+    bigrams = table[offset + mod_taps : offset + mod_taps + mod_taps * keys]
+    return {
+        "rows": rows,
+        "cols": cols,
+        "presses": presses,
+        "gap_average": gap_average,
+        "counts": [counts[l * keys : (l + 1) * keys] for l in range(layers)],
+        "mod_taps": [(s >> 4, s & 0x0F) for s in slots],
+        "bigrams": [bigrams[m * keys : (m + 1) * keys] for m in range(mod_taps)],
+    }
+
+
+def draw(grid, cols, counts, top):
+    for visual_row in grid:
+        numbers, shades = [], []
+        for pos in visual_row:
+            if pos is None:
+                numbers.append("     ")
+                shades.append("     ")
+                continue
+            n = counts[pos[0] * cols + pos[1]]
+            numbers.append(f"{n:5}")
+            shades.append(" " + SHADES[min(len(SHADES) - 1, n * (len(SHADES) - 1) // top if top else 0)] * 3 + " ")
+        print("   " + "".join(numbers))
+        print("   " + "".join(shades))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--board", choices=sorted(BOARDS), help="layout to draw, from the USB product name by default")
+    parser.add_argument("-l", "--layer", type=int, action="append", help="only draw this layer, repeatable")
+    parser.add_argument("-b", "--bigrams", type=int, default=10, metavar="N", help="mod-tap bigrams listed (default 10)")
+    parser.add_argument("--dump", metavar="FILE", help="write the table to FILE")
+    parser.add_argument("--load", metavar="FILE", help="draw a table previously written with --dump or sim -H")
+    parser.add_argument("--clear", action="store_true", help="reset the counters on the keyboard and exit")
+    args = parser.parse_args()
+
+    board = args.board
+    if args.load:
+        with open(args.load, "rb") as f:
+            info = f.read(PACKET_SIZE)
+            table = f.read()
+    else:
+        dev, product = open_keyboard()
+        if args.clear:
+            request(dev, CMD_CLEAR)
+            return
+        board = board or ("planck" if "planck" in product.lower() else "unicorne" if "corne" in product.lower() else None)
+        info, table = read_table(dev)
+        if args.dump:
+            with open(args.dump, "wb") as f:
+                f.write(info + table)
+    if not board:
+        sys.exit("cannot tell the board, pass --board")
+
+    grid, names = BOARDS[board]
+    heat = parse(info, table)
+    cols = heat["cols"]
+    rate = f", {60000 * 16 / heat['gap_average']:.0f} keys/min average" if heat["gap_average"] else ""
+    print(f"{board}: {heat['presses']} presses since boot{rate}")
+
+    for layer, counts in enumerate(heat["counts"]):
+        total = sum(counts)
+        if (args.layer and layer not in args.layer) or (not args.layer and total == 0):
+            continue
+        name = names[layer] if layer < len(names) else f"layer {layer}"
+        print(f"\n{name} ({total} presses)")
+        draw(grid, cols, counts, max(counts))
+
+    pairs = []
+    for slot, (row, col) in enumerate(heat["mod_taps"]):
+        if (row << 4 | col) == NO_KEY:
+            continue
+        for key, n in enumerate(heat["bigrams"][slot]):
+            if n:
+                pairs.append((n, (row, col), divmod(key, cols)))
+    if pairs and args.bigrams:
+        print("\nmod-tap then key (matrix row,col)")
+        for n, first, second in sorted(pairs, reverse=True)[: args.bigrams]:
+            print(f"  {first[0]},{first[1]} -> {second[0]},{second[1]}  {n}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+# Copyright 2024 jonfk
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Query and change the jonfk keymap at runtime over raw HID.
+
+Build the keymap with HID_COMMAND_ENABLE = yes (on for both boards), then
+
+    util/hid_command.py state                        # layers, mods and macros
+    util/hid_command.py layer 1                      # default layer until restart
+    util/hid_command.py layer 0 --persist            # and store it in EEPROM
+    util/hid_command.py macro MA_WI_COPY             # show a macro
+    util/hid_command.py macro MA_WI_PSTE LSFT(KC_INS)
+    util/hid_command.py macro MA_WI_CUT KC_HOME LSFT(KC_END) LCTL(KC_X)
+    util/hid_command.py macro MA_WI_CUT --builtin    # back to the built-in macro
+    util/hid_command.py key 0 2 1                    # keycode at layer 0, matrix row 2, col 1
+    util/hid_command.py key 0 2 1 KC_ESC             # remap it, stored in EEPROM
+    util/hid_command.py keymap --reset               # back to the compiled keymap
+
+Keycodes are KC_ names of basic keys, optionally wrapped in modifiers as in
+the keymaps, or numbers such as 0x0106. Macros set this way last until the
+keyboard restarts; remaps need KEYMAP_STORE_ENABLE and are kept in EEPROM
+until the keymap is reset or a changed keymap.c is flashed. Requires the `hid` package (hidapi).
+"""
+
+import argparse
+import re
+import string
+import struct
+import sys
+
+RAW_USAGE_PAGE = 0xFF60
+RAW_USAGE = 0x61
+PACKET_SIZE = 32
+
+HID_COMMAND_ID = 0x43
+HID_COMMAND_VERSION = 2
+CMD_INFO, CMD_STATE, CMD_SET_LAYER, CMD_GET_MACRO, CMD_SET_MACRO, CMD_GET_KEY, CMD_SET_KEY, CMD_RESET_KEYMAP = range(8)
+STATUS = {0: "ok", 1: "unknown command, is the firmware built with this feature?", 2: "invalid argument, or no room left in the keymap store"}
+
+MACROS = ["MA_WI_COPY", "MA_WI_CUT", "MA_WI_PSTE"]  # slot order, as in jonfk.h
+
+MODS = {"LCTL": 0x01, "LSFT": 0x02, "LALT": 0x04, "LGUI": 0x08, "RCTL": 0x11, "RSFT": 0x12, "RALT": 0x14, "RGUI": 0x18}
+MOD_BITS = ["CTL", "SFT", "ALT", "GUI"]
+
+BASIC = {f"KC_{c}": 0x04 + i for i, c in enumerate(string.ascii_uppercase)}
+BASIC.update({f"KC_{d}": 0x1E + i for i, d in enumerate("1234567890")})
+BASIC.update({f"KC_F{n}": 0x3A + n - 1 for n in range(1, 13)})
+# fmt: off
+BASIC.update({
+    "KC_ENT": 0x28, "KC_ESC": 0x29, "KC_BSPC": 0x2A, "KC_TAB": 0x2B, "KC_SPC": 0x2C, "KC_MINS": 0x2D,
+    "KC_EQL": 0x2E, "KC_LBRC": 0x2F, "KC_RBRC": 0x30, "KC_BSLS": 0x31, "KC_SCLN": 0x33, "KC_QUOT": 0x34,
+    "KC_GRV": 0x35, "KC_COMM": 0x36, "KC_DOT": 0x37, "KC_SLSH": 0x38, "KC_CAPS": 0x39, "KC_PSCR": 0x46,
+    "KC_INS": 0x49, "KC_HOME": 0x4A, "KC_PGUP": 0x4B, "KC_DEL": 0x4C, "KC_END": 0x4D, "KC_PGDN": 0x4E,
+    "KC_RGHT": 0x4F, "KC_LEFT": 0x50, "KC_DOWN": 0x51, "KC_UP": 0x52,
+})
+# fmt: on
+NAMES = {v: k for k, v in BASIC.items()}
+
+WRAPPED = re.compile(r"^([A-Z]{4})\((.*)\)$")
+
+
+def parse_keycode(text):
+    text = text.strip().upper()
+    m = WRAPPED.match(text)
+    if m:
+        if m.group(1) not in MODS:
+            raise ValueError(f"unknown modifier {m.group(1)}")
+        inner = parse_keycode(m.group(2))
+        mods = (inner >> 8) | MODS[m.group(1)]
+        return (mods & 0x1F) << 8 | (inner & 0xFF)
+    if text in BASIC:
+        return BASIC[text]
+    try:
+        value = int(text, 0)
+    except ValueError:
+        raise ValueError(f"unknown keycode {text}") from None
+    if not 0 <= value <= 0xFFFF:
+        raise ValueError(f"keycode {text} out of range")
+    return value
+
+
+def keycode_name(keycode):
+    mods, basic = keycode >> 8, keycode & 0xFF
+    if mods > 0x1F:
+        return f"0x{keycode:04X}"
+    name = NAMES.get(basic, f"0x{basic:02X}")
+    side = "R" if mods & 0x10 else "L"
+    for bit, mod in enumerate(MOD_BITS):
+        if mods & (1 << bit):
+            name = f"{side}{mod}({name})"
+    return name
+
+
+def mods_names(mods):
+    names = [f"{side}{mod}" for side, shift in (("L", 0), ("R", 4)) for bit, mod in enumerate(MOD_BITS) if mods & (1 << (bit + shift))]
+    return "+".join(names) or "none"
+
+
+def open_keyboard():
+    import hid
+
+    for info in hid.enumerate():
+        if info["usage_page"] == RAW_USAGE_PAGE and info["usage"] == RAW_USAGE:
+            dev = hid.device()
+            dev.open_path(info["path"])
+            return dev
+    sys.exit("no raw HID interface found")
+
+
+def request(dev, command, body=b""):
+    # Leading zero is the report ID expected by hidapi.
+    packet = bytes([0, HID_COMMAND_ID, command, 0]) + body + bytes(PACKET_SIZE - 3 - len(body))
+    dev.write(packet)
+    reply = bytes(dev.read(PACKET_SIZE, 1000))
+    if len(reply) < PACKET_SIZE or reply[0] != HID_COMMAND_ID or reply[1] != command:
+        sys.exit("unexpected reply from keyboard")
+    if reply[2] != 0:
+        sys.exit(STATUS.get(reply[2], f"status {reply[2]}"))
+    return reply[3:]
+
+
+def layer_list(state):
+    return ", ".join(str(i) for i in range(32) if state & (1 << i)) or "none"
+
+
+def describe_macro(dev, slot):
+    reply = request(dev, CMD_GET_MACRO, bytes([slot]))
+    count = reply[1]
+    if count == 0:
+        return "built-in"
+    return " ".join(keycode_name(k) for k in struct.unpack_from(f"<{count}H", reply, 2))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+    commands.add_parser("state", help="print layers, mods and macros")
+    layer = commands.add_parser("layer", help="switch the default layer")
+    layer.add_argument("layer", type=int)
+    layer.add_argument("--persist", action="store_true", help="also store it in EEPROM")
+    macro = commands.add_parser("macro", help="show or replace a macro")
+    macro.add_argument("name", choices=MACROS)
+    macro.add_argument("keys", nargs="*", help="keycodes to tap, in order")
+    macro.add_argument("--builtin", action="store_true", help="go back to the built-in macro")
+    key = commands.add_parser("key", help="show or remap a key")
+    key.add_argument("layer", type=int)
+    key.add_argument("row", type=int)
+    key.add_argument("col", type=int)
+    key.add_argument("keycode", nargs="?")
+    keymap = commands.add_parser("keymap", help="show the keymap store")
+    keymap.add_argument("--reset", action="store_true", help="drop every remap")
+    args = parser.parse_args()
+
+    dev = open_keyboard()
+    version, layers, slots, max_keys, remappable, stored, capacity = struct.unpack_from("<BBBBBHH", request(dev, CMD_INFO))
+    if version != HID_COMMAND_VERSION:
+        sys.exit(f"command protocol version {version}, this script speaks {HID_COMMAND_VERSION}")
+
+    if args.command == "state":
+        layer_state, default_state, keymap_config, mods, oneshot = struct.unpack_from("<IIHBB", request(dev, CMD_STATE))
+        print(f"default layer  {layer_list(default_state)} of {layers}")
+        print(f"active layers  {layer_list(layer_state)}")
+        print(f"mods           {mods_names(mods)}, one-shot {mods_names(oneshot)}")
+        print(f"keymap_config  0x{keymap_config:04X}")
+        for slot, name in enumerate(MACROS[:slots]):
+            print(f"{name:<14} {describe_macro(dev, slot)}")
+    elif args.command == "key":
+        position = bytes([args.layer, args.row, args.col])
+        if args.keycode is None:
+            print(keycode_name(struct.unpack_from("<H", request(dev, CMD_GET_KEY, position), 3)[0]))
+            return
+        try:
+            keycode = parse_keycode(args.keycode)
+        except ValueError as e:
+            sys.exit(str(e))
+        request(dev, CMD_SET_KEY, position + struct.pack("<H", keycode))
+    elif args.command == "keymap":
+        if args.reset:
+            request(dev, CMD_RESET_KEYMAP)
+        elif remappable:
+            print(f"{remappable} of {layers} layers remappable, {stored} of {capacity} bytes used")
+        else:
+            print("not remappable, build with KEYMAP_STORE_ENABLE = yes")
+    elif args.command == "layer":
+        request(dev, CMD_SET_LAYER, bytes([args.layer, args.persist]))
+    elif args.keys or args.builtin:
+        try:
+            keys = [parse_keycode(k) for k in args.keys]
+        except ValueError as e:
+            sys.exit(str(e))
+        if len(keys) > max_keys:
+            sys.exit(f"a macro holds at most {max_keys} keycodes")
+        request(dev, CMD_SET_MACRO, struct.pack(f"<BB{len(keys)}H", MACROS.index(args.name), len(keys), *keys))
+    else:
+        print(describe_macro(dev, MACROS.index(args.name)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+# Copyright 2024 jonfk
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Drain the jonfk latency trace over raw HID and print per-stage histograms.
+
+Build the keymap with LATENCY_TRACE_ENABLE = yes, type for a while, then run
+
+    util/latency.py                  # first keyboard exposing the raw HID interface
+    util/latency.py --dump out.bin   # also keep the raw records
+    util/latency.py --load out.bin   # decode a previous dump without a keyboard
+
+Requires the `hid` package (hidapi) unless --load is used.
+"""
+
+import argparse
+import struct
+import sys
+from collections import defaultdict
+
+RAW_USAGE_PAGE = 0xFF60
+RAW_USAGE = 0x61
+PACKET_SIZE = 32
+
+LATENCY_HID_ID = 0x4C
+CMD_INFO, CMD_DRAIN, CMD_CLEAR = 0, 1, 2
+
+RECORD = struct.Struct("<IBBH")
+STAGE_KEY, STAGE_RESOLVED, STAGE_HANDLED = 0, 1, 2
+
+SPANS = [
+    ("combo + tap-hold", STAGE_KEY, STAGE_RESOLVED),
+    ("process + report", STAGE_RESOLVED, STAGE_HANDLED),
+    ("key to report", STAGE_KEY, STAGE_HANDLED),
+]
+
+# Histogram bucket upper bounds, in microseconds.
+BUCKETS = [10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 200000, 500000]
+
+
+def open_keyboard():
+    import hid
+
+    for info in hid.enumerate():
+        if info["usage_page"] == RAW_USAGE_PAGE and info["usage"] == RAW_USAGE:
+            dev = hid.device()
+            dev.open_path(info["path"])
+            return dev
+    sys.exit("no raw HID interface found")
+
+
+def request(dev, command):
+    # Leading zero is the report ID expected by hidapi.
+    packet = bytes([0, LATENCY_HID_ID, command]) + bytes(PACKET_SIZE - 2)
+    dev.write(packet)
+    reply = bytes(dev.read(PACKET_SIZE, 1000))
+    if len(reply) < PACKET_SIZE or reply[0] != LATENCY_HID_ID:
+        sys.exit("unexpected reply from keyboard")
+    return reply
+
+
+def read_trace(dev):
+    info = request(dev, CMD_INFO)
+    ticks_per_ms, capacity, dropped = struct.unpack_from("<IHH", info, 1)
+    records = bytearray()
+    while True:
+        reply = request(dev, CMD_DRAIN)
+        n = reply[1]
+        if n == 0:
+            break
+        records += reply[2 : 2 + n * RECORD.size]
+    return ticks_per_ms, capacity, dropped, bytes(records)
+
+
+def pair_spans(records, ticks_per_ms):
+    """Match the stages of each key event, oldest first, per matrix position."""
+    open_events = defaultdict(list)  # key -> [{stage: ticks}]
+    spans = defaultdict(list)
+    for ticks, stage, key, _keycode in records:
+        events = open_events[key]
+        if stage == STAGE_KEY:
+            events.append({STAGE_KEY: ticks})
+            # Presses consumed by a combo never resolve on their own position.
+            del events[:-4]
+            continue
+        event = next((e for e in events if stage not in e and (stage == STAGE_RESOLVED or STAGE_RESOLVED in e)), None)
+        if event is None:
+            if stage != STAGE_RESOLVED:
+                continue
+            event = {}  # combo events start at resolution
+            events.append(event)
+        event[stage] = ticks
+        if stage == STAGE_HANDLED:
+            events.remove(event)
+            for name, start, end in SPANS:
+                if start in event:
+                    delta = (event[end] - event[start]) & 0xFFFFFFFF
+                    spans[name].append(delta * 1000 / ticks_per_ms)
+    return spans
+
+
+def histogram(name, values):
+    values = sorted(values)
+    p = lambda q: values[min(len(values) - 1, int(q * len(values)))]
+    print(f"{name}: n={len(values)} p50={p(0.5):.0f}us p95={p(0.95):.0f}us max={values[-1]:.0f}us")
+    lower = 0
+    for upper in BUCKETS + [float("inf")]:
+        count = sum(1 for v in values if lower <= v < upper)
+        if count:
+            label = f"<{upper}us" if upper != float("inf") else f">={lower}us"
+            print(f"  {label:>10} {count:6} {'#' * max(1, 50 * count // len(values))}")
+        lower = upper
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--dump", metavar="FILE", help="write the drained records to FILE")
+    parser.add_argument("--load", metavar="FILE", help="decode records previously written with --dump")
+    parser.add_argument("--clear", action="store_true", help="discard the trace on the keyboard and exit")
+    args = parser.parse_args()
+
+    if args.load:
+        with open(args.load, "rb") as f:
+            ticks_per_ms, capacity, dropped = struct.unpack("<IHH", f.read(8))
+            data = f.read()
+    else:
+        dev = open_keyboard()
+        if args.clear:
+            request(dev, CMD_CLEAR)
+            return
+        ticks_per_ms, capacity, dropped, data = read_trace(dev)
+        if args.dump:
+            with open(args.dump, "wb") as f:
+                f.write(struct.pack("<IHH", ticks_per_ms, capacity, dropped) + data)
+
+    if ticks_per_ms == 0:
+        sys.exit("keyboard has not calibrated its counter yet, try again in a second")
+    records = [RECORD.unpack_from(data, i) for i in range(0, len(data) - RECORD.size + 1, RECORD.size)]
+    print(f"{len(records)} records, {ticks_per_ms} ticks/ms, buffer {capacity}, dropped {dropped}")
+    spans = pair_spans(records, ticks_per_ms)
+    for name, _, _ in SPANS:
+        if spans[name]:
+            histogram(name, spans[name])
+
+
+if __name__ == "__main__":
+    main()
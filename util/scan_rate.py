@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# Copyright 2024 jonfk
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Read the jonfk scan rate meter over raw HID and compare silent and playing scan rates.
+
+Build the Planck keymap with WAVETABLE_AUDIO_ENABLE = yes, then run
+
+    util/scan_rate.py --clear    # forget earlier windows
+    util/scan_rate.py            # play a song or music mode for a few seconds first
+    util/scan_rate.py --watch 2  # print again every 2 seconds
+
+Only windows where audio played throughout, or not at all, are counted.
+Requires the `hid` package (hidapi).
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+RAW_USAGE_PAGE = 0xFF60
+RAW_USAGE = 0x61
+PACKET_SIZE = 32
+
+WAVETABLE_HID_ID = 0x57
+CMD_INFO, CMD_CLEAR = 0, 1
+
+INFO = struct.Struct("<IBH")
+RATE = struct.Struct("<IIH")  # last, min, windows
+
+
+def open_keyboard():
+    import hid
+
+    for info in hid.enumerate():
+        if info["usage_page"] == RAW_USAGE_PAGE and info["usage"] == RAW_USAGE:
+            dev = hid.device()
+            dev.open_path(info["path"])
+            return dev
+    sys.exit("no raw HID interface found")
+
+
+def request(dev, command):
+    # Leading zero is the report ID expected by hidapi.
+    packet = bytes([0, WAVETABLE_HID_ID, command]) + bytes(PACKET_SIZE - 2)
+    dev.write(packet)
+    reply = bytes(dev.read(PACKET_SIZE, 1000))
+    if len(reply) < PACKET_SIZE or reply[0] != WAVETABLE_HID_ID:
+        sys.exit("unexpected reply from keyboard")
+    return reply
+
+
+def report(reply):
+    sample_rate, voices, window_ms = INFO.unpack_from(reply, 1)
+    silent = RATE.unpack_from(reply, 1 + INFO.size)
+    playing = RATE.unpack_from(reply, 1 + INFO.size + RATE.size)
+    print(f"{voices} voices at {sample_rate} Hz, {window_ms} ms windows")
+    for name, (last, low, windows) in (("silent", silent), ("playing", playing)):
+        if windows:
+            print(f"  {name:<8} {last:6} scans/s last, {low:6} min, {windows} windows")
+        else:
+            print(f"  {name:<8} no windows yet")
+    if silent[2] and playing[2]:
+        print(f"  audio costs {100 * (1 - playing[1] / silent[1]):.1f}% of the scan rate (min against min)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--clear", action="store_true", help="discard the counted windows and exit")
+    parser.add_argument("--watch", type=float, metavar="SECONDS", help="keep printing at this interval")
+    args = parser.parse_args()
+
+    dev = open_keyboard()
+    if args.clear:
+        request(dev, CMD_CLEAR)
+        return
+    while True:
+        report(request(dev, CMD_INFO))
+        if not args.watch:
+            break
+        time.sleep(args.watch)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+# Copyright 2024 jonfk
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Build every qmk.json target under a matrix of feature flags and report flash/RAM.
+
+    util/size_report.py                       # each target as configured, then with each feature off
+    util/size_report.py --matrix full         # every combination of the features a target enables
+    util/size_report.py -t planck/rev7 -s 30  # one target, top 30 symbols
+    util/size_report.py --matrix full -f AUDIO_ENABLE -f STENO_ENABLE
+    make size                                 # same as the first, through the userspace Makefile
+
+Each build goes to its own directory under <qmk_home>/.build/size so objects
+of different variants never mix. Turning a flag off also turns off the
+features that need it, e.g. -AUDIO_ENABLE takes the wavetable and encoder
+notes with it. Flash is .text + .data and RAM is .data +
+.bss, as reported by `size`; the configured build is broken down by object
+group and by symbol. The script exits with status 1 when any build exceeds
+its budget in util/size_budget.json.
+
+Requires a qmk_firmware checkout (`qmk config user.qmk_home`) and the
+arm-none-eabi binutils.
+"""
+
+import argparse
+import itertools
+import json
+import os
+import re
+import subprocess
+import sys
+from collections import defaultdict
+
+USERSPACE = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+
+# Flags toggled by the matrix. Only those a target turns on are turned off.
+FEATURES = [
+    "AUDIO_ENABLE",
+    "COMBO_ENABLE",
+    "CAPS_WORD_ENABLE",
+    "DEFERRED_EXEC_ENABLE",
+    "ENCODER_MAP_ENABLE",
+    "STENO_ENABLE",
+    "PREDICTIVE_TAP_HOLD_ENABLE",
+    "TAPPING_TERM_TUNER_ENABLE",
+    "MACRO_QUEUE_ENABLE",
+    "SETTINGS_CACHE_ENABLE",
+    "ENCODER_SCROLL_ENABLE",
+    "ENCODER_NOTES_ENABLE",
+    "WAVETABLE_AUDIO_ENABLE",
+    "EAGER_DEBOUNCE_ENABLE",
+    "SPLIT_SYNC_ENABLE",
+    "LAYER_LIGHTS_ENABLE",
+    "TIMER_WHEEL_ENABLE",
+    "ADAPTIVE_SCAN_ENABLE",
+    "TEXT_EXPANSION_ENABLE",
+    "HEATMAP_ENABLE",
+    "KEYMAP_STORE_ENABLE",
+    "HID_COMMAND_ENABLE",
+    "LATENCY_TRACE_ENABLE",
+    "TLOG_ENABLE",
+]
+
+# Flags that users/jonfk/rules.mk forces on for a feature. FLAG=no on the make
+# command line overrides those assignments, so a variant that turns a flag off
+# also turns off every feature that needs it.
+FORCES = {
+    "TEXT_EXPANSION_ENABLE": ["MACRO_QUEUE_ENABLE"],
+    "SETTINGS_CACHE_ENABLE": ["TIMER_WHEEL_ENABLE"],
+    "ENCODER_NOTES_ENABLE": ["AUDIO_ENABLE"],
+    "WAVETABLE_AUDIO_ENABLE": ["AUDIO_ENABLE"],
+    "KEYMAP_STORE_ENABLE": ["HID_COMMAND_ENABLE"],
+}
+
+# Object groups, first match wins.
+GROUPS = [
+    ("keymap", "/keymaps/"),
+    ("userspace", "/users/"),
+    ("quantum", "/quantum/"),
+    ("tmk_core", "/tmk_core/"),
+    ("platforms", "/platforms/"),
+    ("lib", "/lib/"),
+]
+
+# Top level only; indented assignments are inside an ifeq, see FORCES.
+RULE = re.compile(r"^([A-Z0-9_]+)\s*(\?=|:=|=)\s*(\S+)")
+
+
+def read_flags(path, flags):
+    try:
+        with open(path) as f:
+            for line in f:
+                m = RULE.match(line)
+                if m and m.group(1) in FEATURES and not (m.group(2) == "?=" and m.group(1) in flags):
+                    flags[m.group(1)] = m.group(3) == "yes"
+    except FileNotFoundError:
+        pass
+
+
+def enabled_features(keyboard, keymap):
+    """Features a target builds with: keymap rules.mk first, userspace ?= defaults after."""
+    flags = {}
+    read_flags(os.path.join(USERSPACE, "keyboards", keyboard, "keymaps", keymap, "rules.mk"), flags)
+    read_flags(os.path.join(USERSPACE, "users", keymap, "rules.mk"), flags)
+    changed = True
+    while changed:
+        changed = False
+        for feature, forced in FORCES.items():
+            for flag in forced:
+                if flags.get(feature) and not flags.get(flag):
+                    flags[flag] = changed = True
+    return [f for f in FEATURES if flags.get(f)]
+
+
+def turned_off(off, features):
+    """The flags to pass as FLAG=no: those asked for and every enabled feature that needs one of them."""
+    result = set(off)
+    changed = True
+    while changed:
+        changed = False
+        for feature, forced in FORCES.items():
+            if feature in features and feature not in result and result.intersection(forced):
+                result.add(feature)
+                changed = True
+    return tuple(f for f in FEATURES if f in result)
+
+
+def variants(features, matrix):
+    """(name, flags turned off) pairs, the configured build first; variants that end up the same are built once."""
+    yield "configured", ()
+    if matrix == "single":
+        combinations = [(feature,) for feature in features]
+    else:
+        combinations = [off for n in range(1, len(features) + 1) for off in itertools.combinations(features, n)]
+    seen = set()
+    for asked in combinations:
+        off = turned_off(asked, features)
+        if off in seen:
+            continue
+        seen.add(off)
+        yield " ".join(f"-{f}" for f in off), off
+
+
+def filesafe(keyboard, keymap):
+    return f"{keyboard.replace('/', '_')}_{keymap}"
+
+
+def build(qmk_home, keyboard, keymap, off, build_dir, jobs):
+    cmd = ["make", "-C", qmk_home, f"-j{jobs}", f"{keyboard}:{keymap}", f"QMK_USERSPACE={USERSPACE}", f"BUILD_DIR={build_dir}", "SKIP_GIT=yes"]
+    cmd += [f"{feature}=no" for feature in off]
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout)
+        return False
+    return True
+
+
+def berkeley_size(tool, paths):
+    """{path: (text, data, bss)} from `size -B`."""
+    out = subprocess.run([tool, "-B", *paths], stdout=subprocess.PIPE, check=True, text=True).stdout
+    sizes = {}
+    for line in out.splitlines()[1:]:
+        fields = line.split()
+        sizes[fields[5]] = tuple(int(x) for x in fields[:3])
+    return sizes
+
+
+def symbols(tool, elf):
+    """(size, section class, name) for every sized symbol, largest first."""
+    out = subprocess.run([tool, "-S", "--size-sort", "-r", "-t", "d", elf], stdout=subprocess.PIPE, check=True, text=True).stdout
+    result = []
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) != 4:
+            continue
+        kind = fields[2].lower()
+        section = {"t": "text", "r": "text", "w": "text", "d": "data", "b": "bss"}.get(kind)
+        if section:
+            result.append((int(fields[1]), section, fields[3]))
+    return result
+
+
+def flash_ram(text, data, bss):
+    return text + data, data + bss
+
+
+def print_groups(tool, obj_dir):
+    objects = [os.path.join(root, name) for root, _, names in os.walk(obj_dir) for name in names if name.endswith(".o")]
+    if not objects:
+        return
+    groups = defaultdict(lambda: [0, 0, 0])
+    userspace = []
+    for path, size in berkeley_size(tool, objects).items():
+        rel = os.path.relpath(path, obj_dir)
+        name = next((g for g, marker in GROUPS if marker in "/" + rel), "other")
+        for i in range(3):
+            groups[name][i] += size[i]
+        if name in ("keymap", "userspace"):
+            userspace.append((rel, size))
+    print("  by object group        text    data     bss")
+    for name, (text, data, bss) in sorted(groups.items(), key=lambda g: -sum(g[1])):
+        print(f"    {name:<16} {text:8} {data:7} {bss:7}")
+    print("  keymap and userspace objects")
+    for rel, (text, data, bss) in sorted(userspace, key=lambda o: -sum(o[1])):
+        print(f"    {rel:<40} {text:8} {data:7} {bss:7}")
+
+
+def print_symbols(tool, elf, count):
+    by_section = defaultdict(list)
+    for size, section, name in symbols(tool, elf):
+        by_section[section].append((size, name))
+    for section in ("text", "data", "bss"):
+        print(f"  largest .{section} symbols")
+        for size, name in by_section[section][:count]:
+            print(f"    {size:8}  {name}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--qmk-home", help="qmk_firmware checkout, defaults to `qmk config user.qmk_home`")
+    parser.add_argument("--matrix", choices=["single", "full"], default="single", help="turn features off one at a time (default) or in every combination")
+    parser.add_argument("-t", "--target", action="append", help="keyboard or keyboard:keymap to build, repeatable; all of qmk.json by default")
+    parser.add_argument("-f", "--feature", action="append", choices=FEATURES, metavar="FLAG", help="only vary FLAG, repeatable; --matrix full over every feature is 2^n builds")
+    parser.add_argument("-s", "--symbols", type=int, default=15, metavar="N", help="symbols listed per section (default 15)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="make jobs per build")
+    parser.add_argument("--budget", default=os.path.join(USERSPACE, "util", "size_budget.json"), help="budget file")
+    parser.add_argument("--prefix", default="arm-none-eabi-", help="binutils prefix")
+    args = parser.parse_args()
+
+    qmk_home = args.qmk_home or os.environ.get("QMK_HOME")
+    if not qmk_home:
+        out = subprocess.run(["qmk", "config", "-ro", "user.qmk_home"], stdout=subprocess.PIPE, text=True).stdout
+        qmk_home = out.strip().split("=", 1)[-1]
+    if not qmk_home or qmk_home == "None":
+        sys.exit("cannot find qmk_firmware, pass --qmk-home")
+
+    with open(os.path.join(USERSPACE, "qmk.json")) as f:
+        targets = json.load(f)["build_targets"]
+    if args.target:
+        targets = [(kb, km) for kb, km in targets if kb in args.target or f"{kb}:{km}" in args.target]
+    with open(args.budget) as f:
+        budgets = json.load(f)
+
+    size_tool = args.prefix + "size"
+    nm_tool = args.prefix + "nm"
+    failed = False
+    for keyboard, keymap in targets:
+        budget = budgets.get(keyboard, {})
+        features = [f for f in enabled_features(keyboard, keymap) if not args.feature or f in args.feature]
+        print(f"{keyboard}:{keymap}  budget flash {budget.get('flash', '-')} ram {budget.get('ram', '-')}")
+        print(f"  {'variant':<48} {'text':>8} {'data':>7} {'bss':>7} {'flash':>8} {'ram':>7} {'dflash':>7} {'dram':>7}")
+        baseline = None
+        for name, off in variants(features, args.matrix):
+            slug = "configured" if not off else "_".join(f.replace("_ENABLE", "").lower() for f in off)
+            build_dir = os.path.join(qmk_home, ".build", "size", filesafe(keyboard, keymap), slug)
+            if not build(qmk_home, keyboard, keymap, off, build_dir, args.jobs):
+                print(f"  {name:<48} build failed")
+                failed = True
+                continue
+            elf = os.path.join(build_dir, filesafe(keyboard, keymap) + ".elf")
+            text, data, bss = berkeley_size(size_tool, [elf])[elf]
+            flash, ram = flash_ram(text, data, bss)
+            if baseline is None:
+                baseline = (flash, ram, elf, os.path.join(build_dir, "obj_" + filesafe(keyboard, keymap)))
+            over = [kind for kind, used in (("flash", flash), ("ram", ram)) if kind in budget and used > budget[kind]]
+            failed |= bool(over)
+            mark = "  OVER " + "+".join(over) if over else ""
+            print(f"  {name:<48} {text:8} {data:7} {bss:7} {flash:8} {ram:7} {flash - baseline[0]:7} {ram - baseline[1]:7}{mark}")
+        if baseline:
+            print_groups(size_tool, baseline[3])
+            print_symbols(nm_tool, baseline[2], args.symbols)
+        print()
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
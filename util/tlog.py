@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+# Copyright 2024 jonfk
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Decode the jonfk tokenized log (TLOG_ENABLE) back into text.
+
+    util/tlog.py                             # read the keyboard's HID console
+    sim/build/sim_planck sim/traces/planck_dvorak.trace | util/tlog.py -
+
+The formats come from users/jonfk/tlog_tokens.h, so decode with the same
+checkout the firmware was built from. Console text that is not a log record,
+such as the core's own debug output, is passed through. Reading the keyboard
+requires the `hid` package (hidapi).
+"""
+
+import os
+import re
+import sys
+import time
+
+CONSOLE_USAGE_PAGE = 0xFF31
+CONSOLE_USAGE = 0x74
+REPORT_SIZE = 32
+
+TLOG_SYNC = 0x1E
+TOKENS_H = os.path.join(os.path.dirname(os.path.dirname(os.path.realpath(__file__))), "users", "jonfk", "tlog_tokens.h")
+TOKEN = re.compile(r'^\s*TLOG_TOKEN\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', re.M)
+SPEC = re.compile(r"%([udxc%])")
+
+
+def load_formats(path):
+    with open(path) as f:
+        return [(name, fmt.encode().decode("unicode_escape")) for name, fmt in TOKEN.findall(f.read())]
+
+
+class Decoder:
+    """Splits a console byte stream into log messages and plain text."""
+
+    def __init__(self, formats):
+        self.formats = formats
+        self.pending = bytearray()
+        self.text = bytearray()
+
+    def feed(self, data):
+        self.pending += data
+        out = []
+        while self.pending:
+            if self.pending[0] != TLOG_SYNC:
+                byte = self.pending.pop(0)
+                if byte == ord("\n"):
+                    out.append(self.text.decode(errors="replace"))
+                    self.text.clear()
+                elif byte:  # padding of a short console report
+                    self.text.append(byte)
+                continue
+            message, used = self.record(self.pending)
+            if used == 0:
+                break  # the rest of the record is in a later report
+            del self.pending[:used]
+            out.append(message)
+        return out
+
+    def record(self, data):
+        """(message, bytes used), or (None, 0) when data ends mid-record."""
+        if len(data) < 2:
+            return None, 0
+        token = data[1]
+        if token >= len(self.formats):
+            return f"<unknown token {token}, tlog_tokens.h is older than the firmware>", 2
+        name, fmt = self.formats[token]
+        specs = [s for s in SPEC.findall(fmt) if s != "%"]
+        args, pos = [], 2
+        for spec in specs:
+            value, shift = 0, 0
+            while True:
+                if pos >= len(data):
+                    return None, 0
+                byte = data[pos]
+                pos += 1
+                value |= (byte & 0x7F) << shift
+                shift += 7
+                if not byte & 0x80:
+                    break
+            if spec == "d" and value & 0x80000000:
+                value -= 1 << 32
+            args.append(value)
+        message = fmt % tuple(args)
+        if name == "BOOT" and args and args[0] != len(self.formats):
+            message += f" (tlog_tokens.h has {len(self.formats)}, decode with the firmware's checkout)"
+        return message, pos
+
+
+def reports_from_keyboard():
+    import hid
+
+    for info in hid.enumerate():
+        if info["usage_page"] == CONSOLE_USAGE_PAGE and info["usage"] == CONSOLE_USAGE:
+            dev = hid.device()
+            dev.open_path(info["path"])
+            break
+    else:
+        sys.exit("no HID console found, is the firmware built with TLOG_ENABLE = yes?")
+    while True:
+        yield time.strftime("%H:%M:%S"), bytes(dev.read(REPORT_SIZE))
+
+
+def reports_from_sim(lines):
+    for line in lines:
+        fields = line.split()
+        if len(fields) > 2 and fields[1] == "console":
+            yield fields[0], bytes(int(b, 16) for b in fields[2:])
+
+
+def main():
+    if len(sys.argv) > 2 or (len(sys.argv) == 2 and sys.argv[1] != "-"):
+        sys.exit(__doc__)
+    decoder = Decoder(load_formats(TOKENS_H))
+    source = reports_from_sim(sys.stdin) if len(sys.argv) == 2 else reports_from_keyboard()
+    for stamp, data in source:
+        for message in decoder.feed(data):
+            print(f"{stamp:>8}  {message}", flush=True)
+
+
+if __name__ == "__main__":
+    main()